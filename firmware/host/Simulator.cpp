@@ -0,0 +1,629 @@
+#include "Simulator.h"
+#include "pico_sim.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// Pin map (as ComputerCard.h)
+// ---------------------------------------------------------------------------
+
+static constexpr uint PIN_PULSE_1_IN = 2;
+static constexpr uint PIN_PULSE_2_IN = 3;
+static constexpr uint PIN_NORM_PROBE = 4;
+static constexpr uint PIN_BOARD_ID_1 = 6; // tied high on Rev1.1 hardware
+static constexpr uint PIN_PULSE_1_OUT = 8;  // inverted
+static constexpr uint PIN_PULSE_2_OUT = 9;  // inverted
+static constexpr uint PIN_CV_OUT_1 = 23;
+static constexpr uint PIN_CV_OUT_2 = 22;
+static constexpr uint PIN_MX_A = 24;
+static constexpr uint PIN_MX_B = 25;
+
+static constexpr int SAMPLE_RATE = 48000;
+static constexpr double PWM_WRAPS_PER_SAMPLE = 150e6 / 2048 / SAMPLE_RATE; // ~1.53
+static constexpr int UNPATCHED_PROBE_LEVEL = 1000; // native level seen via the probe
+
+// ---------------------------------------------------------------------------
+// Simulated hardware state
+// ---------------------------------------------------------------------------
+
+adc_hw_t sim_adc_hw;
+dma_hw_t sim_dma_hw;
+pwm_hw_t sim_pwm_hw;
+uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+
+struct spi_inst {
+  spi_hw_t hw;
+};
+struct i2c_inst {
+  uint baudrate;
+};
+static spi_inst spi0_inst;
+static i2c_inst i2c0_inst;
+spi_inst_t *const sim_spi0 = &spi0_inst;
+i2c_inst_t *const sim_i2c0 = &i2c0_inst;
+
+namespace {
+
+sim::Options opts;
+
+volatile bool pinOut[NUM_BANK0_GPIOS];
+volatile uint16_t pwmLevel[NUM_BANK0_GPIOS];
+
+struct DmaChannel {
+  bool claimed = false;
+  dma_channel_config config = {};
+  volatile void *writeAddr = nullptr;
+  const volatile void *readAddr = nullptr;
+  uint32_t count = 0; // transfer count reloaded on each trigger
+  bool active = false;
+};
+DmaChannel dma[NUM_DMA_CHANNELS];
+
+irq_handler_t irqHandler[NUM_IRQS];
+volatile bool irqEnabled[NUM_IRQS];
+volatile bool pwmIrqEnabled = false;
+std::atomic<bool> adcRunning{false};
+
+// Model outputs, native units (updated by the clock thread)
+int32_t audioOut[2] = {0, 0};
+int32_t cvOut[2] = {0, 0};
+bool pulseOut[2] = {false, false};
+bool pulseIn[2] = {false, false};
+
+// ADC DNL correction inverse: corrected value → raw ADC code
+uint16_t adcInverse[4096];
+
+// USB CDC over a pseudo-terminal
+int ptyMaster = -1, ptySlave = -1;
+uint8_t rxBuf[4096];
+size_t rxLen = 0, rxPos = 0;
+uint8_t txBuf[4096];
+size_t txLen = 0;
+
+// Calibration EEPROM (--eeprom): 256 bytes, address pointer set by a
+// one-byte write, advanced by reads
+uint8_t eeprom[256];
+uint8_t eepromPtr = 0;
+
+// Stats
+std::atomic<uint64_t> statTicks{0}, statIsrNs{0}, statIsrMaxNs{0}, statCvIrqNs{0};
+std::atomic<uint64_t> statRx{0}, statTx{0}, statTxDropped{0};
+
+const auto bootTime = std::chrono::steady_clock::now();
+
+// Same arithmetic as ComputerCard::CorrectADCDNL
+uint16_t CorrectDNL(uint16_t value) {
+  uint16_t adc512 = value + 512;
+  value += ((value & 0x3FF) == 0x1FF) << 2;
+  value += (adc512 >> 10) << 3;
+  return uint32_t(value * 520349) >> 19;
+}
+
+void BuildADCInverse() {
+  int best[4096];
+  for (int c = 0; c < 4096; c++)
+    best[c] = -1;
+  for (int raw = 0; raw < 4096; raw++) {
+    uint16_t c = CorrectDNL(raw);
+    if (c < 4096 && best[c] < 0)
+      best[c] = raw;
+  }
+  // Codes the correction skips map to their nearest neighbour
+  int last = 0;
+  for (int c = 0; c < 4096; c++) {
+    if (best[c] >= 0)
+      last = best[c];
+    adcInverse[c] = last;
+  }
+}
+
+// Native value (-2048..2047, positive = positive voltage) → raw inverted ADC code
+uint16_t NativeToADC(int32_t native) {
+  int32_t c = 2048 - native;
+  if (c < 0)
+    c = 0;
+  if (c > 4095)
+    c = 4095;
+  return adcInverse[c];
+}
+
+uint16_t UnipolarToADC(int32_t value) {
+  if (value < 0)
+    value = 0;
+  if (value > 4095)
+    value = 4095;
+  return adcInverse[value];
+}
+
+// Same CRC as ComputerCard::CRCencode
+uint16_t CRC16(const uint8_t *data, int length) {
+  uint16_t crc = 0xFFFF;
+  for (int i = 0; i < length; i++) {
+    crc ^= ((uint16_t)data[i]) << 8;
+    for (int bit = 0; bit < 8; bit++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+// Three-point calibration a little off ComputerCard's defaults, in the
+// layout ComputerCard::ReadEEPROM expects
+void BuildEEPROM() {
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  eeprom[0] = 2001 >> 8; // magic
+  eeprom[1] = 2001 & 0xFF;
+  eeprom[2] = 0; // version
+  eeprom[3] = 0;
+  const int8_t volts[3] = {-20, 0, 20};
+  const uint32_t dac[2][3] = {{347900, 261350, 174550}, {347600, 261100, 174250}};
+  for (int channel = 0; channel < 2; channel++) {
+    uint8_t *p = &eeprom[4 + 41 * channel];
+    *p++ = 3;
+    for (int point = 0; point < 3; point++) {
+      *p++ = (uint8_t)volts[point];
+      for (int shift = 24; shift >= 0; shift -= 8)
+        *p++ = (uint8_t)(dac[channel][point] >> shift);
+    }
+  }
+  uint16_t crc = CRC16(eeprom, 86);
+  eeprom[86] = crc >> 8;
+  eeprom[87] = crc & 0xFF;
+}
+
+// Bus time for one transfer: address byte plus len bytes, 9 clocks each
+// (with ACK), plus start and stop
+void I2CTransferTime(const i2c_inst_t *i2c, size_t len) {
+  sleep_us(((len + 1) * 9 + 2) * 1000000ull / i2c->baudrate);
+}
+
+void SaveFlash() {
+  if (!opts.flashFile)
+    return;
+  FILE *f = fopen(opts.flashFile, "wb");
+  if (!f)
+    return;
+  fwrite(sim_flash, 1, sizeof(sim_flash), f);
+  fclose(f);
+}
+
+void LoadFlash() {
+  memset(sim_flash, 0xFF, sizeof(sim_flash));
+  if (!opts.flashFile)
+    return;
+  FILE *f = fopen(opts.flashFile, "rb");
+  if (!f)
+    return;
+  size_t n = fread(sim_flash, 1, sizeof(sim_flash), f);
+  (void)n;
+  fclose(f);
+}
+
+void OpenPty() {
+  ptyMaster = posix_openpt(O_RDWR | O_NOCTTY);
+  if (ptyMaster < 0 || grantpt(ptyMaster) != 0 || unlockpt(ptyMaster) != 0) {
+    perror("sim: posix_openpt");
+    exit(1);
+  }
+  const char *name = ptsname(ptyMaster);
+
+  // Keep the slave open ourselves so the master never sees a hangup
+  // between host connections, and make the line raw (no echo/CRLF).
+  ptySlave = open(name, O_RDWR | O_NOCTTY);
+  struct termios tio;
+  tcgetattr(ptySlave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(ptySlave, TCSANOW, &tio);
+  fcntl(ptyMaster, F_SETFL, fcntl(ptyMaster, F_GETFL) | O_NONBLOCK);
+
+  if (opts.link) {
+    unlink(opts.link);
+    if (symlink(name, opts.link) != 0)
+      perror("sim: symlink");
+  }
+  fprintf(stderr, "sim: Workshop Computer on %s%s%s\n", name, opts.link ? " → " : "",
+          opts.link ? opts.link : "");
+}
+
+void FlushTx() {
+  if (!txLen)
+    return;
+  ssize_t n = write(ptyMaster, txBuf, txLen);
+  // Like USB CDC with nobody reading: what doesn't fit is dropped
+  if (n < 0)
+    n = 0;
+  statTx += n;
+  statTxDropped += txLen - n;
+  txLen = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Sample clock
+// ---------------------------------------------------------------------------
+
+void DmaTrigger(uint channel) {
+  dma[channel].active = true;
+  sim_dma_hw.ch[channel].transfer_count = dma[channel].count;
+}
+
+// One transfer of a paced channel, and the chain when it completes. Only
+// what the CV PWM DMA needs: 32-bit words into a PWM compare register,
+// restarted by a control channel writing al3_read_addr_trig.
+void DmaTransfer(uint channel) {
+  DmaChannel &ch = dma[channel];
+  if (!ch.active || !ch.readAddr || !ch.writeAddr)
+    return;
+  for (uint s = 0; s < 8; s++) {
+    if (ch.writeAddr == &sim_pwm_hw.slice[s].cc) {
+      uint32_t cc = *(const volatile uint32_t *)ch.readAddr;
+      sim_pwm_hw.slice[s].cc = cc;
+      for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (pwm_gpio_to_slice_num(gpio) == s)
+          pwmLevel[gpio] = (gpio & 1) ? cc >> 16 : cc & 0xFFFF; // odd pins are channel B
+      }
+    }
+  }
+  for (uint c = 0; c < NUM_DMA_CHANNELS; c++) {
+    if (ch.writeAddr == &sim_dma_hw.ch[c].al3_read_addr_trig) {
+      dma[c].readAddr = *(const volatile void *const *)ch.readAddr;
+      DmaTrigger(c);
+    }
+  }
+  if (ch.config.read_increment)
+    ch.readAddr = (const volatile uint8_t *)ch.readAddr + 4;
+  if (--sim_dma_hw.ch[channel].transfer_count == 0) {
+    ch.active = false;
+    if (ch.config.chain_to != channel) {
+      DmaTrigger(ch.config.chain_to);
+      DmaTransfer(ch.config.chain_to); // unpaced: one transfer completes it
+    }
+  }
+}
+
+void Tick() {
+  DmaChannel *adc = nullptr, *spi = nullptr;
+  for (auto &ch : dma) {
+    if (!ch.claimed)
+      continue;
+    if (ch.config.dreq == DREQ_ADC)
+      adc = &ch;
+    if (ch.config.dreq == DREQ_SPI0_TX)
+      spi = &ch;
+  }
+
+  // DAC: the SPI DMA has just sent the buffer it was pointed at
+  if (spi && spi->readAddr) {
+    const volatile uint16_t *words = (const volatile uint16_t *)spi->readAddr;
+    for (int i = 0; i < 2; i++)
+      audioOut[i] = -(int32_t)((words[i] & 0x0FFF) - 0x800); // undo dacval() and output inversion
+  }
+  pulseOut[0] = !pinOut[PIN_PULSE_1_OUT];
+  pulseOut[1] = !pinOut[PIN_PULSE_2_OUT];
+
+  // Input model: patched inputs follow their source, unpatched follow the probe
+  bool probe = pinOut[PIN_NORM_PROBE];
+  int32_t unpatched = probe ? UNPATCHED_PROBE_LEVEL : -UNPATCHED_PROBE_LEVEL;
+  int32_t audioIn[2], cvIn[2];
+  for (int i = 0; i < 2; i++) {
+    audioIn[i] = opts.loopback ? audioOut[i] : unpatched;
+    cvIn[i] = opts.loopback ? cvOut[i] : unpatched;
+    pulseIn[i] = opts.loopback ? pulseOut[i] : probe;
+  }
+
+  // ADC: round robin 0-3 twice, mux selected by MX_A/MX_B
+  if (adc && adc->writeAddr) {
+    int mux = pinOut[PIN_MX_A] | (pinOut[PIN_MX_B] << 1);
+    static const int switchLevel[3] = {0, 2048, 4095};
+    int32_t knob = mux < 3 ? opts.knobs[mux] : switchLevel[opts.switchPos];
+    volatile uint16_t *buf = (volatile uint16_t *)adc->writeAddr;
+    for (int i = 0; i < 8; i += 4) {
+      buf[i + 0] = NativeToADC(audioIn[1]); // ADC0: Audio In 2
+      buf[i + 1] = NativeToADC(audioIn[0]); // ADC1: Audio In 1
+      buf[i + 2] = UnipolarToADC(knob);     // ADC2: knobs + switch via mux
+      buf[i + 3] = NativeToADC(cvIn[mux & 1]); // ADC3: CV In 1/2 via mux
+    }
+  }
+
+  // DMA complete → audio ISR
+  if (irqEnabled[DMA_IRQ_0] && irqHandler[DMA_IRQ_0]) {
+    auto t0 = std::chrono::steady_clock::now();
+    irqHandler[DMA_IRQ_0]();
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - t0)
+                      .count();
+    statIsrNs += ns;
+    if (ns > statIsrMaxNs)
+      statIsrMaxNs = ns;
+  }
+
+  // CV PWM wraps, averaged back to native units
+  static double wrapPhase = 0;
+  double levelSum[2] = {0, 0};
+  int wraps = 0;
+  for (wrapPhase += PWM_WRAPS_PER_SAMPLE; wrapPhase >= 1.0; wrapPhase -= 1.0) {
+    for (uint c = 0; c < NUM_DMA_CHANNELS; c++) {
+      if (dma[c].claimed && dma[c].config.dreq == DREQ_PWM_WRAP0 + pwm_gpio_to_slice_num(PIN_CV_OUT_1))
+        DmaTransfer(c);
+    }
+    if (pwmIrqEnabled && irqEnabled[PWM_IRQ_WRAP] && irqHandler[PWM_IRQ_WRAP]) {
+      auto t0 = std::chrono::steady_clock::now();
+      irqHandler[PWM_IRQ_WRAP]();
+      statCvIrqNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - t0)
+                         .count();
+    }
+    levelSum[0] += pwmLevel[PIN_CV_OUT_1];
+    levelSum[1] += pwmLevel[PIN_CV_OUT_2];
+    wraps++;
+  }
+  if (wraps) {
+    for (int i = 0; i < 2; i++)
+      cvOut[i] = (int32_t)lround(2047.0 - 2.0 * levelSum[i] / wraps);
+  }
+
+  statTicks++;
+}
+
+void PrintStats() {
+  static uint64_t lastTicks = 0, lastIsrNs = 0, lastCvIrqNs = 0, lastRx = 0, lastTx = 0, lastDropped = 0;
+  uint64_t ticks = statTicks, isrNs = statIsrNs, cvIrqNs = statCvIrqNs, rx = statRx, tx = statTx,
+           dropped = statTxDropped;
+  uint64_t dt = ticks - lastTicks;
+  fprintf(stderr,
+          "sim: %7llu samples/s  isr avg %6.0fns max %6lluns  cv irq %4.0fns  rx %6llu B/s  tx %6llu B/s"
+          "  dropped %llu  out %5d %5d %5d %5d %d%d\n",
+          (unsigned long long)dt, dt ? double(isrNs - lastIsrNs) / dt : 0.0,
+          (unsigned long long)statIsrMaxNs.exchange(0), dt ? double(cvIrqNs - lastCvIrqNs) / dt : 0.0,
+          (unsigned long long)(rx - lastRx),
+          (unsigned long long)(tx - lastTx), (unsigned long long)(dropped - lastDropped),
+          audioOut[0], audioOut[1], cvOut[0], cvOut[1], pulseOut[0], pulseOut[1]);
+  lastTicks = ticks;
+  lastIsrNs = isrNs;
+  lastCvIrqNs = cvIrqNs;
+  lastRx = rx;
+  lastTx = tx;
+  lastDropped = dropped;
+}
+
+void ClockThread() {
+  using clock = std::chrono::steady_clock;
+  auto start = clock::now();
+  auto nextStats = start + std::chrono::seconds(1);
+  uint64_t ticks = 0;
+
+  while (true) {
+    if (!adcRunning || !irqHandler[DMA_IRQ_0]) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      start = clock::now();
+      ticks = 0;
+    } else {
+      // Run a millisecond of samples, then pace against the wall clock
+      for (int i = 0; i < SAMPLE_RATE / 1000; i++)
+        Tick();
+      ticks += SAMPLE_RATE / 1000;
+      if (opts.speed > 0) {
+        auto due = start + std::chrono::nanoseconds((int64_t)(ticks * 1e9 / (SAMPLE_RATE * opts.speed)));
+        std::this_thread::sleep_until(due);
+      }
+    }
+    if (opts.stats && clock::now() >= nextStats) {
+      PrintStats();
+      nextStats += std::chrono::seconds(1);
+    }
+  }
+}
+
+} // namespace
+
+void sim::Start(const Options &options) {
+  opts = options;
+  BuildADCInverse();
+  LoadFlash();
+  if (opts.eeprom)
+    BuildEEPROM();
+  OpenPty();
+  std::thread(ClockThread).detach();
+}
+
+// ---------------------------------------------------------------------------
+// SDK stand-in: GPIO / PWM
+// ---------------------------------------------------------------------------
+
+void gpio_init(uint gpio) { pinOut[gpio] = false; }
+void gpio_set_function(uint, gpio_function) {}
+void gpio_set_dir(uint, bool) {}
+void gpio_put(uint gpio, bool value) { pinOut[gpio] = value; }
+void gpio_set_pulls(uint, bool, bool) {}
+void gpio_pull_up(uint) {}
+void gpio_disable_pulls(uint) {}
+
+bool gpio_get(uint gpio) {
+  switch (gpio) {
+  case PIN_PULSE_1_IN:
+    return !pulseIn[0]; // inverting input stage
+  case PIN_PULSE_2_IN:
+    return !pulseIn[1];
+  case PIN_BOARD_ID_1:
+    return true;
+  default:
+    return pinOut[gpio];
+  }
+}
+
+pwm_config pwm_get_default_config() { return pwm_config{0xFFFF}; }
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap) { c->wrap = wrap; }
+void pwm_init(uint, pwm_config *, bool) {}
+uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7; }
+void pwm_set_gpio_level(uint gpio, uint16_t level) { pwmLevel[gpio] = level; }
+void pwm_clear_irq(uint) {}
+void pwm_set_irq_enabled(uint, bool enabled) { pwmIrqEnabled = enabled; }
+
+// ---------------------------------------------------------------------------
+// SDK stand-in: ADC / DMA / IRQ
+// ---------------------------------------------------------------------------
+
+void adc_init() {}
+void adc_gpio_init(uint) {}
+void adc_select_input(uint) {}
+void adc_set_round_robin(uint) {}
+void adc_fifo_setup(bool, bool, uint16_t, bool, bool) {}
+void adc_set_clkdiv(float) {}
+void adc_run(bool run) { adcRunning = run; }
+
+int dma_claim_unused_channel(bool required) {
+  for (int i = 0; i < NUM_DMA_CHANNELS; i++) {
+    if (!dma[i].claimed) {
+      dma[i] = DmaChannel();
+      dma[i].claimed = true;
+      return i;
+    }
+  }
+  if (required) {
+    fprintf(stderr, "sim: no free DMA channel\n");
+    abort();
+  }
+  return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  return dma_channel_config{DREQ_FORCE, DMA_SIZE_32, true, false, channel};
+}
+void channel_config_set_transfer_data_size(dma_channel_config *c, dma_channel_transfer_size size) { c->size = size; }
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) { c->read_increment = incr; }
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) { c->write_increment = incr; }
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) { c->dreq = dreq; }
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to) { c->chain_to = chain_to; }
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+  dma[channel].config = *config;
+  dma[channel].writeAddr = write_addr;
+  dma[channel].readAddr = read_addr;
+  dma[channel].count = transfer_count;
+  if (trigger)
+    DmaTrigger(channel);
+}
+void dma_channel_set_irq0_enabled(uint, bool) {}
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool) { dma[channel].writeAddr = write_addr; }
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool) { dma[channel].readAddr = read_addr; }
+void dma_channel_cleanup(uint channel) {
+  dma[channel].writeAddr = nullptr;
+  dma[channel].readAddr = nullptr;
+  dma[channel].active = false;
+  dma[channel].config.chain_to = channel;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) { irqHandler[num] = handler; }
+void irq_remove_handler(uint num, irq_handler_t) { irqHandler[num] = nullptr; }
+void irq_set_enabled(uint num, bool enabled) { irqEnabled[num] = enabled; }
+void irq_set_priority(uint, uint8_t) {}
+
+uint32_t save_and_disable_interrupts() { return 0; }
+void restore_interrupts(uint32_t) {}
+
+// ---------------------------------------------------------------------------
+// SDK stand-in: SPI / I2C / flash
+// ---------------------------------------------------------------------------
+
+spi_hw_t *spi_get_hw(spi_inst_t *spi) { return &spi->hw; }
+uint spi_init(spi_inst_t *, uint baudrate) { return baudrate; }
+void spi_set_format(spi_inst_t *, uint, spi_cpol_t, spi_cpha_t, spi_order_t) {}
+
+// Without --eeprom nothing answers, and ComputerCard falls back to default
+// CV calibration. The EEPROM is at 0x50; the device address's low bits
+// would select higher blocks, which this one doesn't have.
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+  i2c->baudrate = baudrate;
+  return baudrate;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool, uint) {
+  if (!opts.eeprom || addr != 0x50 || len < 1)
+    return PICO_ERROR_GENERIC;
+  I2CTransferTime(i2c, len);
+  eepromPtr = src[0];
+  return (int)len;
+}
+
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool, uint) {
+  if (!opts.eeprom || addr != 0x50)
+    return PICO_ERROR_GENERIC;
+  I2CTransferTime(i2c, len);
+  for (size_t i = 0; i < len; i++)
+    dst[i] = eeprom[eepromPtr++];
+  return (int)len;
+}
+
+void flash_get_unique_id(uint8_t *id_out) {
+  for (int i = 0; i < FLASH_UNIQUE_ID_SIZE_BYTES; i++)
+    id_out[i] = (uint8_t)(opts.cardID >> (8 * i));
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+  memset(sim_flash + flash_offs, 0xFF, count);
+  SaveFlash();
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+  for (size_t i = 0; i < count; i++)
+    sim_flash[flash_offs + i] &= data[i]; // programming can only clear bits
+  SaveFlash();
+}
+
+// ---------------------------------------------------------------------------
+// SDK stand-in: multicore / stdio / time / bootrom
+// ---------------------------------------------------------------------------
+
+void multicore_launch_core1(void (*entry)(void)) { std::thread(entry).detach(); }
+void multicore_lockout_victim_init() {}
+void multicore_lockout_start_blocking() {}
+void multicore_lockout_end_blocking() {}
+
+bool stdio_init_all() { return true; }
+
+int getchar_timeout_us(uint32_t timeout_us) {
+  FlushTx();
+  if (rxPos == rxLen) {
+    struct pollfd pfd = {ptyMaster, POLLIN, 0};
+    struct timespec ts = {(time_t)(timeout_us / 1000000), (long)(timeout_us % 1000000) * 1000};
+    if (ppoll(&pfd, 1, &ts, nullptr) <= 0 || !(pfd.revents & POLLIN))
+      return PICO_ERROR_TIMEOUT;
+    ssize_t n = read(ptyMaster, rxBuf, sizeof(rxBuf));
+    if (n <= 0)
+      return PICO_ERROR_TIMEOUT;
+    statRx += n;
+    rxLen = n;
+    rxPos = 0;
+  }
+  return rxBuf[rxPos++];
+}
+
+int putchar_raw(int c) {
+  txBuf[txLen++] = (uint8_t)c;
+  if (txLen == sizeof(txBuf))
+    FlushTx();
+  return c;
+}
+
+void sleep_us(uint64_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+void sleep_ms(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+uint64_t time_us_64() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime)
+      .count();
+}
+uint32_t time_us_32() { return (uint32_t)time_us_64(); }
+
+void rom_reset_usb_boot(uint32_t, uint32_t) {
+  fprintf(stderr, "sim: switch held down — card rebooted to USB bootloader, exiting\n");
+  FlushTx();
+  exit(0);
+}
@@ -0,0 +1,48 @@
+/*
+ * Simulator.h
+ *
+ * Host-side simulated Workshop Computer for running the bridge firmware on
+ * Linux. The firmware is compiled unchanged against the SDK stand-in in
+ * sdk/pico_sim.h; this file models the hardware behind it:
+ *
+ *  - ADC + external mux + DMA: each tick fills the buffer ComputerCard's DMA
+ *    is pointed at, then raises DMA_IRQ_0 so the real BufferFull() runs
+ *  - SPI DAC: audio outputs decoded from the buffer the DMA is reading
+ *  - PWM CV outputs: the wrap IRQ (or wrap-paced DMA) runs ~1.53 times per
+ *    sample, and the dithered 11-bit levels are averaged back into native
+ *    units
+ *  - Normalisation probe: unpatched inputs follow the probe pin
+ *  - I2C EEPROM (optional): CV Out calibration, each transfer taking as
+ *    long as it would on the 100kHz bus
+ *  - USB CDC: getchar/putchar go to a pseudo-terminal, so wc_osc_bridge.py
+ *    can connect with --port /dev/pts/N
+ *
+ * All values are ComputerCard native units (-2048..2047, knobs 0..4095).
+ */
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cstdint>
+
+namespace sim {
+
+struct Options {
+  double speed = 1.0;           // 1 = real time (48kHz), 0 = as fast as possible
+  bool loopback = false;        // patch each output into the matching input
+  int knobs[3] = {0, 0, 0};     // Main, X, Y (0-4095)
+  int switchPos = 1;            // 0 down, 1 middle, 2 up
+  uint64_t cardID = 0x5743534d31ULL; // raw flash unique ID
+  const char *flashFile = nullptr;   // persist simulated flash here
+  bool eeprom = false;               // fit a calibration EEPROM
+  const char *link = nullptr;        // symlink to the pty slave
+  bool stats = false;                // print per-second stats to stderr
+};
+
+// Open the pseudo-terminal, load flash and start the sample clock.
+// Call before the firmware's main().
+void Start(const Options &options);
+
+} // namespace sim
+
+#endif // SIMULATOR_H
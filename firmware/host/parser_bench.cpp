@@ -0,0 +1,95 @@
+// Microbenchmark for the host → device packet parser (BridgeProtocol.h).
+//
+// Builds a stream shaped like wc_osc_bridge.py traffic — mostly 0xC0 data
+// packets, some 0xC2 commands and a little line noise — and times
+// parse_byte() plus decoding over it. Prints parsed packets per second so
+// parser changes can be compared; for scale, a full-speed USB CDC link
+// carries at most ~100k 10-byte packets per second. Exits non-zero if any
+// packet sent is not delivered.
+//
+//   ./build-host/wc_parser_bench [packets] [repeats]
+
+#include "BridgeProtocol.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static uint32_t rng = 12345;
+static uint32_t next_random() {
+  rng = rng * 1664525u + 1013904223u;
+  return rng >> 8;
+}
+
+static std::vector<uint8_t> build_stream(int packets, int &sent) {
+  std::vector<uint8_t> out;
+  out.reserve((size_t)packets * (OUTPUT_PACKET_SIZE + 1));
+  sent = 0;
+  for (int n = 0; n < packets; n++) {
+    uint32_t kind = next_random() % 100;
+    if (kind < 90) {
+      OutputPacket pkt;
+      pkt.flags = (uint8_t)(next_random() & 3);
+      for (int i = 0; i < 4; i++)
+        pkt.values[i] = (int16_t)((int)(next_random() % 4096) - 2048);
+      uint8_t bytes[OUTPUT_PACKET_SIZE];
+      encode_output_packet(pkt, bytes);
+      out.insert(out.end(), bytes, bytes + OUTPUT_PACKET_SIZE);
+    } else if (kind < 99) {
+      out.push_back(SYNC_HOST_COMMAND);
+      out.push_back(CMD_SET_CV_PRECISE);
+      for (int i = 0; i < OUTPUT_PACKET_SIZE - 2; i++)
+        out.push_back((uint8_t)(next_random() & 0x7F));
+    } else {
+      out.push_back((uint8_t)next_random()); // noise
+      continue;
+    }
+    sent++;
+  }
+  return out;
+}
+
+int main(int argc, char **argv) {
+  int packets = argc > 1 ? atoi(argv[1]) : 1000000;
+  int repeats = argc > 2 ? atoi(argv[2]) : 20;
+
+  int sent = 0;
+  std::vector<uint8_t> stream = build_stream(packets, sent);
+
+  // Sum decoded values so the compiler can't drop the work
+  int64_t checksum = 0;
+  long parsed = 0;
+  double best = 1e30;
+  for (int r = 0; r < repeats; r++) {
+    PacketParser parser;
+    long count = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint8_t b : stream) {
+      if (!parse_byte(parser, b) || !payload_is_valid(parser.buf))
+        continue;
+      count++;
+      if (parser.buf[0] == SYNC_HOST_COMMAND) {
+        checksum += unpack_s21(&parser.buf[2]) + unpack_s21(&parser.buf[5]);
+      } else {
+        OutputPacket pkt = decode_output_packet(parser.buf);
+        checksum += pkt.flags + pkt.values[0] + pkt.values[1] + pkt.values[2] + pkt.values[3];
+      }
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (s < best)
+      best = s;
+    parsed = count;
+  }
+
+  printf("stream: %zu bytes, %d packets sent, %ld delivered\n", stream.size(), sent, parsed);
+  printf("best of %d: %.3f ms, %.1f M packets/s, %.1f MB/s, %.2f ns/byte\n", repeats, best * 1e3,
+         parsed / best / 1e6, stream.size() / best / 1e6, best * 1e9 / stream.size());
+  printf("(checksum %lld)\n", (long long)checksum);
+  if (parsed < sent) {
+    fprintf(stderr, "%ld packets lost\n", sent - parsed);
+    return 1;
+  }
+  return 0;
+}
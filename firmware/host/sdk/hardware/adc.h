@@ -0,0 +1,5 @@
+// Host stand-in for the Pico SDK header of the same name
+#ifndef SIM_HARDWARE_ADC_H
+#define SIM_HARDWARE_ADC_H
+#include "pico_sim.h"
+#endif
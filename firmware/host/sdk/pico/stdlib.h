@@ -0,0 +1,5 @@
+// Host stand-in for the Pico SDK header of the same name
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+#include "pico_sim.h"
+#endif
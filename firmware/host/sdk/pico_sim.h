@@ -0,0 +1,215 @@
+/*
+ * pico_sim.h
+ *
+ * Minimal stand-in for the parts of the Pico SDK used by ComputerCard.h and
+ * the bridge firmware, so they can be compiled and run on a Linux host.
+ * Every hardware call lands in the simulated card in Simulator.cpp.
+ *
+ * Only what the firmware actually uses is declared here; add to it as the
+ * firmware grows.
+ */
+
+#ifndef PICO_SIM_H
+#define PICO_SIM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+typedef unsigned int uint;
+
+#define __not_in_flash_func(func_name) func_name
+
+#define PICO_ERROR_TIMEOUT (-1)
+#define PICO_ERROR_GENERIC (-1)
+
+// ---------------------------------------------------------------------------
+// GPIO
+// ---------------------------------------------------------------------------
+
+#define NUM_BANK0_GPIOS 30
+
+enum gpio_function { GPIO_FUNC_SPI = 1, GPIO_FUNC_I2C = 3, GPIO_FUNC_PWM = 4, GPIO_FUNC_SIO = 5, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_NULL = 0x1f };
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+void gpio_init(uint gpio);
+void gpio_set_function(uint gpio, gpio_function fn);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_pulls(uint gpio, bool up, bool down);
+void gpio_pull_up(uint gpio);
+void gpio_disable_pulls(uint gpio);
+
+// ---------------------------------------------------------------------------
+// PWM
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  uint16_t wrap;
+} pwm_config;
+
+pwm_config pwm_get_default_config();
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap);
+void pwm_init(uint slice_num, pwm_config *c, bool start);
+uint pwm_gpio_to_slice_num(uint gpio);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+void pwm_clear_irq(uint slice_num);
+void pwm_set_irq_enabled(uint slice_num, bool enabled);
+
+// Compare register (channel A low half, B high half), written by DMA
+typedef struct {
+  volatile uint32_t cc;
+} pwm_slice_hw_t;
+typedef struct {
+  pwm_slice_hw_t slice[8];
+} pwm_hw_t;
+extern pwm_hw_t sim_pwm_hw;
+#define pwm_hw (&sim_pwm_hw)
+
+// ---------------------------------------------------------------------------
+// ADC
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  volatile uint32_t fifo;
+} adc_hw_t;
+extern adc_hw_t sim_adc_hw;
+#define adc_hw (&sim_adc_hw)
+
+void adc_init();
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+void adc_set_round_robin(uint input_mask);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_set_clkdiv(float clkdiv);
+void adc_run(bool run);
+
+// ---------------------------------------------------------------------------
+// DMA
+// ---------------------------------------------------------------------------
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+enum dreq_num { DREQ_SPI0_TX = 16, DREQ_PWM_WRAP0 = 24, DREQ_ADC = 36, DREQ_FORCE = 63 };
+
+typedef struct {
+  uint dreq;
+  dma_channel_transfer_size size;
+  bool read_increment, write_increment;
+  uint chain_to;
+} dma_channel_config;
+
+// Per-channel registers. A DMA write to al3_read_addr_trig (from another
+// channel) restarts the channel at that address; it holds a host pointer.
+typedef struct {
+  volatile uint32_t transfer_count; // remaining in the current run
+  const volatile void *volatile al3_read_addr_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+  dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+  volatile uint32_t ints0;
+} dma_hw_t;
+extern dma_hw_t sim_dma_hw;
+#define dma_hw (&sim_dma_hw)
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_cleanup(uint channel);
+
+// ---------------------------------------------------------------------------
+// IRQ
+// ---------------------------------------------------------------------------
+
+enum irq_num { DMA_IRQ_0 = 11, PWM_IRQ_WRAP = 4, NUM_IRQS = 32 };
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+void irq_set_priority(uint num, uint8_t hardware_priority);
+
+uint32_t save_and_disable_interrupts();
+void restore_interrupts(uint32_t status);
+
+// The cores are threads here, so a real fence
+static inline void __dmb() { std::atomic_thread_fence(std::memory_order_seq_cst); }
+
+// ---------------------------------------------------------------------------
+// SPI / I2C
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  volatile uint32_t dr;
+} spi_hw_t;
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t *const sim_spi0;
+#define spi0 sim_spi0
+spi_hw_t *spi_get_hw(spi_inst_t *spi);
+
+enum spi_cpol_t { SPI_CPOL_0 = 0, SPI_CPOL_1 = 1 };
+enum spi_cpha_t { SPI_CPHA_0 = 0, SPI_CPHA_1 = 1 };
+enum spi_order_t { SPI_LSB_FIRST = 0, SPI_MSB_FIRST = 1 };
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *const sim_i2c0;
+#define i2c0 sim_i2c0
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us);
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us);
+
+// ---------------------------------------------------------------------------
+// Flash (XIP reads go straight to the simulated flash array)
+// ---------------------------------------------------------------------------
+
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_UNIQUE_ID_SIZE_BYTES 8
+
+extern uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash)
+
+void flash_get_unique_id(uint8_t *id_out);
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+// ---------------------------------------------------------------------------
+// Multicore, stdio, time, bootrom
+// ---------------------------------------------------------------------------
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_lockout_victim_init();
+void multicore_lockout_start_blocking();
+void multicore_lockout_end_blocking();
+
+bool stdio_init_all();
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+uint32_t time_us_32();
+uint64_t time_us_64();
+
+void rom_reset_usb_boot(uint32_t usb_activity_gpio_pin_mask, uint32_t disable_interface_mask);
+
+#endif // PICO_SIM_H
@@ -0,0 +1,90 @@
+// Host entry point for the simulated card: parse options, start the
+// simulated hardware, then hand over to the unmodified firmware main()
+// (compiled as bridge_main, see CMakeLists.txt).
+
+#include "Simulator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+
+int bridge_main();
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --speed X        sample clock relative to 48kHz real time (default 1, 0 = flat out)\n"
+          "  --loopback       patch Audio/CV/Pulse Out N into the matching input\n"
+          "  --knobs M,X,Y    knob positions 0-4095 (default 0,0,0)\n"
+          "  --switch POS     down, middle or up (default middle)\n"
+          "  --card-id HEX    raw flash unique ID (default 5743534d31)\n"
+          "  --flash FILE     keep simulated flash in FILE between runs\n"
+          "  --eeprom         fit a CV Out calibration EEPROM (default: none)\n"
+          "  --link PATH      symlink PATH to the pseudo-terminal\n"
+          "  --stats          print sample rate, ISR times and USB traffic each second\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  sim::Options opts;
+
+  static const struct option longOpts[] = {
+      {"speed", required_argument, nullptr, 's'},   {"loopback", no_argument, nullptr, 'l'},
+      {"knobs", required_argument, nullptr, 'k'},   {"switch", required_argument, nullptr, 'w'},
+      {"card-id", required_argument, nullptr, 'i'}, {"flash", required_argument, nullptr, 'f'},
+      {"link", required_argument, nullptr, 'L'},    {"stats", no_argument, nullptr, 'S'},
+      {"eeprom", no_argument, nullptr, 'e'},        {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  int c;
+  while ((c = getopt_long(argc, argv, "h", longOpts, nullptr)) != -1) {
+    switch (c) {
+    case 's':
+      opts.speed = atof(optarg);
+      break;
+    case 'l':
+      opts.loopback = true;
+      break;
+    case 'k':
+      if (sscanf(optarg, "%d,%d,%d", &opts.knobs[0], &opts.knobs[1], &opts.knobs[2]) != 3) {
+        usage(argv[0]);
+        return 1;
+      }
+      break;
+    case 'w':
+      if (!strcmp(optarg, "down"))
+        opts.switchPos = 0;
+      else if (!strcmp(optarg, "middle"))
+        opts.switchPos = 1;
+      else if (!strcmp(optarg, "up"))
+        opts.switchPos = 2;
+      else {
+        usage(argv[0]);
+        return 1;
+      }
+      break;
+    case 'i':
+      opts.cardID = strtoull(optarg, nullptr, 16);
+      break;
+    case 'f':
+      opts.flashFile = optarg;
+      break;
+    case 'L':
+      opts.link = optarg;
+      break;
+    case 'S':
+      opts.stats = true;
+      break;
+    case 'e':
+      opts.eeprom = true;
+      break;
+    default:
+      usage(argv[0]);
+      return c == 'h' ? 0 : 1;
+    }
+  }
+
+  sim::Start(opts);
+  return bridge_main();
+}
@@ -0,0 +1,208 @@
+/*
+ * BridgeProtocol.h
+ *
+ * Binary USB protocol shared by the bridge firmware and its host-side test
+ * harnesses (see main.cpp for the packet layouts). Everything here is pure:
+ * no SDK calls, no globals, so it compiles unchanged for Linux and the
+ * parser can be fuzzed and benchmarked off-device (firmware/host).
+ */
+
+#ifndef BRIDGE_PROTOCOL_H
+#define BRIDGE_PROTOCOL_H
+
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// Binary protocol constants
+// ---------------------------------------------------------------------------
+
+static constexpr uint8_t SYNC_HOST_TO_DEVICE = 0xC0;
+static constexpr uint8_t SYNC_DEVICE_TO_HOST = 0xC1;
+static constexpr uint8_t SYNC_HOST_COMMAND = 0xC2;
+static constexpr uint8_t SYNC_DEVICE_EVENT = 0xC3;
+static constexpr int OUTPUT_PACKET_SIZE = 10; // host → device (data and command)
+static constexpr int INPUT_PACKET_SIZE = 16;  // device → host (inputs and events)
+
+// Wire format version, sent in EVT_CARD_INFO; the host refuses a card
+// with another. Bump on any incompatible change. Firmware from before
+// it existed sends 0. Version 2: 0xC0 values 7 bits per byte.
+static constexpr uint8_t PROTOCOL_VERSION = 2;
+
+// Command ids (byte 1 of a 0xC2 packet)
+static constexpr uint8_t CMD_SET_CV_MODE = 0x01;    // d0: CV Out 1 mode, d1: CV Out 2 mode
+static constexpr uint8_t CMD_SET_CV_PRECISE = 0x02; // d0-2: CV Out 1, d3-5: CV Out 2 (signed 21-bit)
+static constexpr uint8_t CMD_CALIBRATE_INPUTS = 0x03; // d0: input mask (bit per ComputerCard::Input)
+static constexpr uint8_t CMD_SET_INPUT_UNITS = 0x04;  // d0: 0 native, 1 calibrated millivolts
+static constexpr uint8_t CMD_RESET_INPUT_CAL = 0x05;  // d0: input mask, back to nominal 12V span
+static constexpr uint8_t CMD_SCHEDULE = 0x06; // d0-3: sample clock (low 28 bits), d4: channel, d5-7: value
+static constexpr uint8_t CMD_GET_CARD_INFO = 0x07; // no payload; replies with EVT_CARD_INFO
+static constexpr uint8_t CMD_SET_KNOB_FILTER = 0x08; // d0: 0 smooth, 1 adaptive
+static constexpr uint8_t CMD_SET_CV_IN_FILTER = 0x09; // d0: 0 smooth, 1 raw
+static constexpr uint8_t CMD_SET_NORM_PROBE = 0x0A;   // d0: 0 off, 1 always, 2 scheduled; replies with EVT_JACKS
+static constexpr uint8_t CMD_SET_BOOT_MODE = 0x0B;    // d0: 0 animated, 1 fast; stored in flash
+static constexpr uint8_t CMD_GET_BOOT_TIMES = 0x0C;   // no payload; replies with EVT_BOOT_TIMES
+static constexpr uint8_t CMD_TRIGGER = 0x0D;          // d0: pulse out (0/1), d1-3: width in µs (21-bit)
+static constexpr uint8_t CMD_SET_CLOCK = 0x0E;        // d0: pulse out, d1: source, d2: ×, d3: ÷, d4: swing %,
+                                                      // d5: chance %, d6-7: width in 100µs (see main.cpp)
+static constexpr uint8_t CMD_CLEAR_SCHEDULE = 0x0F;   // no payload; drops scheduled events not yet applied
+
+// CMD_SET_CLOCK sources
+static constexpr uint8_t CLOCK_SOURCE_OFF = 0;
+static constexpr uint8_t CLOCK_SOURCE_PULSE_IN1 = 1;
+static constexpr uint8_t CLOCK_SOURCE_PULSE_IN2 = 2;
+
+// CMD_SCHEDULE channels. Values are native for Audio Out 1-2, and for CV
+// Out 1-2 in native mode; calibrated 19-bit for CV Out 1-2 otherwise;
+// 0/1 for the pulse outs; the trigger width in µs for the trigger channels,
+// which raise a pulse out for that long and then drop it.
+static constexpr uint8_t SCHEDULE_AUDIO_OUT1 = 0;
+static constexpr uint8_t SCHEDULE_AUDIO_OUT2 = 1;
+static constexpr uint8_t SCHEDULE_CV_OUT1 = 2;
+static constexpr uint8_t SCHEDULE_CV_OUT2 = 3;
+static constexpr uint8_t SCHEDULE_PULSE_OUT1 = 4;
+static constexpr uint8_t SCHEDULE_PULSE_OUT2 = 5;
+static constexpr uint8_t SCHEDULE_TRIGGER_OUT1 = 6;
+static constexpr uint8_t SCHEDULE_TRIGGER_OUT2 = 7;
+
+// Event ids (byte 1 of a 0xC3 packet)
+static constexpr uint8_t EVT_INPUT_CAL = 0x01; // u8 input, u8 status, i32 offset_q4, i32 gain_q16
+static constexpr uint8_t EVT_CLOCK = 0x02;     // u32 sample clock of the last report, u8 sequence
+static constexpr uint8_t EVT_CARD_INFO = 0x03; // u64 UniqueCardID, u8 PROTOCOL_VERSION
+static constexpr uint8_t EVT_JACKS = 0x04;     // u8 connected mask (bit per ComputerCard::Input), u8 changed mask
+static constexpr uint8_t EVT_BOOT_TIMES = 0x05; // u8 calibration source, u16 µs x5, u16 ms (see main.cpp)
+static constexpr uint8_t EVT_TEMPO = 0x06;      // u8 pulse in, u32 period (samples × 256, 0 stopped), u32 last edge
+static constexpr uint8_t EVT_SCHEDULE_FULL = 0x07; // u8 channel of the dropped event, u32 events dropped since boot
+
+// EVT_BOOT_TIMES calibration sources (ComputerCard::CalSource)
+static constexpr uint8_t CAL_SOURCE_DEFAULT = 0;
+static constexpr uint8_t CAL_SOURCE_EEPROM = 1;
+static constexpr uint8_t CAL_SOURCE_FLASH_CACHE = 2;
+
+// Input units
+static constexpr uint8_t INPUT_UNITS_NATIVE = 0;
+static constexpr uint8_t INPUT_UNITS_MILLIVOLTS = 1;
+
+// Knob filters (ComputerCard::KnobFilter)
+static constexpr uint8_t KNOB_FILTER_SMOOTH = 0;
+static constexpr uint8_t KNOB_FILTER_ADAPTIVE = 1;
+
+// CV In filters (ComputerCard::CVInFilter)
+static constexpr uint8_t CV_IN_FILTER_SMOOTH = 0;
+static constexpr uint8_t CV_IN_FILTER_RAW = 1;
+
+// Normalisation probe schedules (ComputerCard::NormProbe)
+static constexpr uint8_t NORM_PROBE_OFF = 0;
+static constexpr uint8_t NORM_PROBE_ALWAYS = 1;
+static constexpr uint8_t NORM_PROBE_SCHEDULED = 2;
+
+// Boot modes (CMD_SET_BOOT_MODE)
+static constexpr uint8_t BOOT_MODE_ANIMATED = 0; // startup pattern plays while the bridge runs
+static constexpr uint8_t BOOT_MODE_FAST = 1;     // no startup pattern
+
+// CV Out modes
+static constexpr uint8_t CV_MODE_NATIVE = 0;
+static constexpr uint8_t CV_MODE_MILLIVOLTS = 1;
+static constexpr uint8_t CV_MODE_PRECISE = 2;
+
+// ---------------------------------------------------------------------------
+// Host → device packet parser
+// ---------------------------------------------------------------------------
+//
+// Framing: a packet starts at a sync byte (0xC0 or 0xC2) and is complete
+// after OUTPUT_PACKET_SIZE bytes. Bytes outside a packet are dropped, and a
+// sync byte seen mid-packet restarts the packet there, so the parser
+// recovers within one packet after any corruption.
+//
+// Equivalently: a packet is emitted for every sync byte followed by nine
+// non-sync bytes. Both packet kinds carry 7-bit payloads, so a payload
+// byte is never a sync byte and every packet the host sends arrives
+// whole; packets with a payload byte >= 0x80 are line noise and
+// payload_is_valid() rejects them. The fuzz target checks both.
+
+struct PacketParser {
+  uint8_t buf[OUTPUT_PACKET_SIZE] = {};
+  uint8_t pos = 0;
+};
+
+static inline bool is_host_sync(uint8_t b) {
+  return b == SYNC_HOST_TO_DEVICE || b == SYNC_HOST_COMMAND;
+}
+
+// Feed one byte. Returns true when p.buf holds a complete packet, which
+// stays valid until the next call.
+static inline bool parse_byte(PacketParser &p, uint8_t b) {
+  if (is_host_sync(b)) {
+    // Start of packet, or resync mid-packet
+    p.buf[0] = b;
+    p.pos = 1;
+    return false;
+  }
+  // Wait for sync byte to start a packet
+  if (p.pos == 0)
+    return false;
+
+  p.buf[p.pos++] = b;
+  if (p.pos < OUTPUT_PACKET_SIZE)
+    return false;
+  p.pos = 0;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Packet decoding
+// ---------------------------------------------------------------------------
+
+// 0xC0 data packet: flags + four signed 14-bit values, each as two 7-bit
+// bytes, LSB first (native -2048..2047, or millivolts -6000..6000)
+struct OutputPacket {
+  uint8_t flags;
+  int16_t values[4];
+};
+
+static inline OutputPacket decode_output_packet(const uint8_t *pkt) {
+  OutputPacket out;
+  out.flags = pkt[1];
+  for (int i = 0; i < 4; i++) {
+    int32_t v = pkt[2 + 2 * i] | (pkt[3 + 2 * i] << 7);
+    out.values[i] = (int16_t)((v ^ 0x2000) - 0x2000);
+  }
+  return out;
+}
+
+// Inverse of decode_output_packet, as wc_osc_bridge.py's data_packet()
+// builds it; values must be in -8192..8191
+static inline void encode_output_packet(const OutputPacket &in, uint8_t *pkt) {
+  pkt[0] = SYNC_HOST_TO_DEVICE;
+  pkt[1] = in.flags & 0x7F;
+  for (int i = 0; i < 4; i++) {
+    pkt[2 + 2 * i] = (uint8_t)(in.values[i] & 0x7F);
+    pkt[3 + 2 * i] = (uint8_t)((in.values[i] >> 7) & 0x7F);
+  }
+}
+
+// 0xC0 and 0xC2 payload bytes must be 7-bit; anything else is line noise
+static inline bool payload_is_valid(const uint8_t *pkt) {
+  for (int i = 1; i < OUTPUT_PACKET_SIZE; i++) {
+    if (pkt[i] & 0x80)
+      return false;
+  }
+  return true;
+}
+
+// Sign-extend a 21-bit value packed as three 7-bit bytes, LSB first
+static inline int32_t unpack_s21(const uint8_t *p) {
+  int32_t v = p[0] | (p[1] << 7) | (p[2] << 14);
+  return (v ^ 0x100000) - 0x100000;
+}
+
+// 21-bit value packed as three 7-bit bytes, LSB first
+static inline uint32_t unpack_u21(const uint8_t *p) {
+  return p[0] | (p[1] << 7) | (p[2] << 14);
+}
+
+// 28-bit value packed as four 7-bit bytes, LSB first
+static inline uint32_t unpack_u28(const uint8_t *p) {
+  return p[0] | (p[1] << 7) | (p[2] << 14) | ((uint32_t)p[3] << 21);
+}
+
+#endif // BRIDGE_PROTOCOL_H
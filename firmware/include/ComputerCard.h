@@ -12,6 +12,23 @@ to use the jacks, knobs, switch and LEDs, for programs running at
 a fixed 48kHz audio sample rate.
 
 See examples/ directory
+
+Define COMPUTERCARD_DNL_LUT (before including, or on the compiler
+command line) to correct ADC DNL errors with an 8KB lookup table built
+at startup, rather than arithmetic in the audio interrupt.
+
+Define COMPUTERCARD_FLASH_CACHE_OFFSET as the offset of a spare flash
+sector to keep a copy of the CV output calibration and card ID there.
+Startup then reads only the EEPROM's magic number and CRC (4 bytes
+rather than 88) and skips the flash unique ID command; the sector is
+rewritten whenever the EEPROM no longer matches it. Construct
+ComputerCard before launching core 1, as the rewrite erases flash.
+
+Define COMPUTERCARD_CV_DMA to dither the CV outputs by DMA instead of
+the PWM wrap interrupt (~73kHz): the audio interrupt computes the same
+delta-sigma sequence a few PWM periods ahead into a ring that chained
+DMA channels copy into the PWM compare register on each wrap. Costs
+two more DMA channels; CV output changes take up to ~60us longer.
 */
 
 
@@ -46,6 +63,16 @@ public:
 	enum HardwareVersion_t {Proto1=0x2a, Proto2_Rev1=0x30, Rev1_1=0x0C, Unknown=0xFF};
 	/// USB Power state
 	enum USBPowerState_t {DFP, UFP, Unsupported};
+	/// Knob smoothing, used by SetKnobFilter
+	enum KnobFilter {KnobSmooth, KnobAdaptive};
+	/// CV input smoothing, used by SetCVInFilter
+	enum CVInFilter {CVInSmooth, CVInRaw};
+	/// Normalisation probe schedule, used by SetNormalisationProbe
+	enum NormProbe {NormProbeOff, NormProbeAlways, NormProbeScheduled};
+	/// Where the CV output calibration was loaded from
+	enum CalSource {CalDefault, CalEEPROM, CalFlashCache};
+	/// Constructor phases, timed by StartupTime
+	enum StartupPhase {StartupEntered, StartupHardware, StartupCalibration, StartupCardID, StartupCacheWrite, NumStartupPhases};
 
 	ComputerCard();
 
@@ -61,7 +88,38 @@ public:
 	}
 
 	/// Use before Run() to enable Connected/Disconnected detection
-	void EnableNormalisationProbe() {useNormProbe = true;}
+	void EnableNormalisationProbe() {normProbe = NormProbeAlways;}
+
+	/** \brief Choose when the normalisation probe runs.
+
+		NormProbeAlways probes continuously (as EnableNormalisationProbe).
+		NormProbeScheduled probes for ~11ms once a second, and only changes
+		Connected/Disconnected once two probes in a row agree, so a plug or
+		unplug takes between 1 and 2 seconds to show.
+		NormProbeOff stops probing and drives the probe low;
+		Connected/Disconnected keep their last values, and inputs last seen
+		disconnected still read zero.
+		Can be changed at any time, including from the other core.
+	*/
+	void SetNormalisationProbe(NormProbe p) {normProbe = p;}
+
+	/** \brief Choose how knobs (and the switch) are smoothed.
+
+		KnobSmooth (default) is a fixed one-pole filter, about 15Hz per knob.
+		KnobAdaptive follows the knob within ~1ms while it is turned and
+		smooths harder than KnobSmooth while it is still.
+		Can be changed at any time, including from the other core.
+	*/
+	void SetKnobFilter(KnobFilter f) {knobFilter = f;}
+
+	/** \brief Choose how CV inputs are smoothed.
+
+		CVInSmooth (default) is a ~240Hz one-pole, good for V/oct.
+		CVInRaw gives the unfiltered (DNL-corrected) samples, each CV input
+		updated at 24kHz, for audio-rate modulation.
+		Can be changed at any time, including from the other core.
+	*/
+	void SetCVInFilter(CVInFilter f) {cvInFilter = f;}
 	
 	static ComputerCard *ThisPtr() {return thisptr;}
 
@@ -194,6 +252,25 @@ protected:
 	}
 
 	
+	/// Set CV output from calibrated 19-bit value (values -262144 to 262143, approx -6V to +6V)
+	void __not_in_flash_func(CVOutCalibrated)(int i, int32_t val)
+	{
+		cvValue[i] = CalibratedToDAC(val, i);
+	}
+	
+	/// Set CV 1 output from calibrated 19-bit value (values -262144 to 262143)
+	void __not_in_flash_func(CVOut1Calibrated)(int32_t val)
+	{
+		cvValue[0] = CalibratedToDAC(val, 0);
+	}
+	
+	/// Set CV 2 output from calibrated 19-bit value (values -262144 to 262143)
+	void __not_in_flash_func(CVOut2Calibrated)(int32_t val)
+	{
+		cvValue[1] = CalibratedToDAC(val, 1);
+	}
+
+	
 	/// Set Pulse output (true = on)
 	void __not_in_flash_func(PulseOut)(int i, bool val)
 	{
@@ -310,6 +387,19 @@ protected:
 		return cvOutsCalibrated;
 	}
 
+	/// Return where the CV output calibration was loaded from
+	CalSource CVOutsCalibrationSource() const
+	{
+		return calSource;
+	}
+
+	/// Return time (µs since reset) at which a phase of the constructor
+	/// finished; StartupEntered is when the constructor was entered
+	uint32_t StartupTime(StartupPhase phase) const
+	{
+		return startupTime[phase];
+	}
+
 	
 	void Abort();
 
@@ -332,20 +422,67 @@ private:
 	static constexpr int calMaxChannels = 2;
 	static constexpr int calMaxPoints = 10;
 
+	// Piecewise-linear lookup from calibrated 19-bit value to DAC setting,
+	// 32 segments of 0.375V, built from the calibration table at startup
+	static constexpr int calLookupShift = 14;
+	static constexpr int calLookupSize = 1 << (19 - calLookupShift);
+
 	static volatile uint32_t cvValue[2];
 	
 	uint8_t numCalibrationPoints[calMaxChannels];
 	CalPoint calibrationTable[calMaxChannels][calMaxPoints];
 	CalCoeffs calCoeffs[calMaxChannels];
+	int32_t calLookup[calMaxChannels][calLookupSize + 1];
 
 	uint64_t uniqueID;
-	
+	uint16_t eepromCRC = 0;
+	CalSource calSource = CalDefault;
+	uint32_t startupTime[NumStartupPhases];
+
+#ifdef COMPUTERCARD_FLASH_CACHE_OFFSET
+	// Copy of the EEPROM calibration and the card ID, kept in flash
+	typedef struct
+	{
+		uint32_t magic;
+		uint16_t eepromCRC;  // CRC field of the EEPROM the table came from
+		uint8_t eepromValid; // 0: no valid EEPROM, table holds the defaults
+		uint8_t numCalibrationPoints[calMaxChannels];
+		CalPoint calibrationTable[calMaxChannels][calMaxPoints];
+		uint64_t uniqueID;   // already mixed
+		uint16_t crc;        // CRCencode of the fields above
+	} CalCache;
+	static constexpr uint32_t calCacheMagic = 0x43434331;
+
+	const CalCache *ValidCalCache();
+	void UpdateCalCache(const CalCache *cache);
+#endif
+
 	uint8_t ReadByteFromEEPROM(unsigned int eeAddress, bool &failed);
 	int ReadIntFromEEPROM(unsigned int eeAddress, bool &failed);
 	void CalcCalCoeffs(int channel);
+	void CalcCalLookup(int channel);
 	int ReadEEPROM();
 	uint32_t MIDIToDAC(int midiNote, int channel);
 	uint32_t MillivoltsToDAC(int millivolts, int channel, bool &limited);
+
+	// Convert calibrated 19-bit value to DAC setting: one lookup, one multiply, no division
+	uint32_t __not_in_flash_func(CalibratedToDAC)(int32_t val, int channel)
+	{
+		if (val < -262144) val = -262144;
+		if (val > 262143) val = 262143;
+		uint32_t u = val + 262144;
+		uint32_t seg = u >> calLookupShift;
+		int32_t frac = u & ((1 << calLookupShift) - 1);
+		int32_t lo = calLookup[channel][seg];
+		// The DAC setting falls as voltage rises, so the step is negative:
+		// round its magnitude to nearest rather than shift toward -inf
+		int32_t step = (calLookup[channel][seg + 1] - lo) * frac;
+		int32_t mag = ((step < 0 ? -step : step) + (1 << (calLookupShift - 1))) >> calLookupShift;
+		int32_t dacValue = lo + (step < 0 ? -mag : mag);
+		if (dacValue > 524287) dacValue = 524287;
+		if (dacValue < 0) dacValue = 0;
+		return dacValue;
+	}
 	
 	HardwareVersion_t hw;
 	HardwareVersion_t ProbeHardwareVersion();
@@ -353,6 +490,8 @@ private:
 	int16_t dacOut[2];
 	
 	volatile int32_t knobs[4] = { 0, 0, 0, 0 }; // 0-4095
+	volatile KnobFilter knobFilter = KnobSmooth;
+	volatile CVInFilter cvInFilter = CVInSmooth;
 	volatile bool pulse[2] = { 0, 0 };
 	volatile bool last_pulse[2] = { 0, 0 };
 	volatile int32_t cv[2] = { 0, 0 }; // -2047 - 2048
@@ -362,7 +501,12 @@ private:
 
 	volatile int32_t plug_state[6] = {0,0,0,0,0,0};
 	volatile bool connected[6] = {0,0,0,0,0,0};
-	bool useNormProbe;
+	volatile NormProbe normProbe;
+
+	// NormProbeScheduled: probe for normProbeBurst samples (32 fresh probe
+	// bits) every normProbePeriod samples
+	static constexpr int normProbeBurst = 512;
+	static constexpr int normProbePeriod = 48000;
 
 	Switch switchVal, lastSwitchVal;
 	
@@ -375,6 +519,9 @@ private:
 	uint16_t SPI_Buffer[2][2];
 
 	uint8_t adc_dma, spi_dma; // DMA ids
+#ifdef COMPUTERCARD_CV_DMA
+	uint8_t cv_dma, cv_dma_ctrl;
+#endif
 
 
 
@@ -390,7 +537,12 @@ private:
 	uint32_t next_norm_probe();
 
 	
+	static uint16_t DNLCorrected(uint16_t value);
     void CorrectADCDNL(uint16_t &value) const;
+#ifdef COMPUTERCARD_DNL_LUT
+	// CorrectADCDNL result for every 12-bit ADC value, filled by the constructor
+	static uint16_t dnlTable[4096];
+#endif
 	
 	void BufferFull();
 
@@ -402,6 +554,17 @@ private:
 	}
 	static ComputerCard *thisptr;
 
+#ifdef COMPUTERCARD_CV_DMA
+	// Ring of PWM compare values (both CV outputs, one word per PWM wrap),
+	// played by cv_dma and refilled cvDitherLead wraps ahead by FillCVDither
+	static constexpr uint32_t cvDitherLength = 32; // power of 2
+	static constexpr uint32_t cvDitherLead = 4;
+	static uint32_t cvDither[cvDitherLength];
+	static uint32_t *cvDitherStart; // cv_dma_ctrl reloads cv_dma's read address from here
+	uint32_t cvDitherWrite = 0;
+	void FillCVDither();
+#endif
+
 	// 19-bit CV outputs
 	static void OnCVPWMWrap()
 	{
@@ -429,6 +592,9 @@ private:
 #include "hardware/i2c.h"
 #include "hardware/irq.h"
 #include "hardware/spi.h"
+#include "hardware/sync.h"
+#include <cstddef>
+#include <cstring>
 
 // Input normalisation probe pin
 #define NORMALISATION_PROBE 4
@@ -490,6 +656,15 @@ volatile uint32_t ComputerCard::cvValue[2] = {262144,262144};
 
 ComputerCard *ComputerCard::thisptr;
 
+#ifdef COMPUTERCARD_DNL_LUT
+uint16_t ComputerCard::dnlTable[4096];
+#endif
+
+#ifdef COMPUTERCARD_CV_DMA
+uint32_t ComputerCard::cvDither[cvDitherLength];
+uint32_t *ComputerCard::cvDitherStart = ComputerCard::cvDither;
+#endif
+
 // Return pseudo-random bit for normalisation probe
 uint32_t __not_in_flash_func(ComputerCard::next_norm_probe)()
 {
@@ -541,14 +716,42 @@ void __not_in_flash_func(ComputerCard::AudioWorker)()
 	irq_set_exclusive_handler(DMA_IRQ_0, ComputerCard::AudioCallback);
 
 
-	// Turn on IRQ for CV output PWM
 	uint slice_num = pwm_gpio_to_slice_num(CV_OUT_1);
+#ifdef COMPUTERCARD_CV_DMA
+	// Set up DMA for CV output PWM: cv_dma copies one word of the dither
+	// ring into the slice's compare register per PWM wrap, then chains to
+	// cv_dma_ctrl, which restarts it at the top of the ring
+	for (uint32_t i = 0; i < cvDitherLength; i++)
+	{
+		cvDither[i] = (1024u << 16) | 1024u;
+	}
+	cvDitherWrite = 0;
+	cv_dma = dma_claim_unused_channel(true);
+	cv_dma_ctrl = dma_claim_unused_channel(true);
+
+	dma_channel_config cv_dmacfg = dma_channel_get_default_config(cv_dma);
+	channel_config_set_transfer_data_size(&cv_dmacfg, DMA_SIZE_32);
+	channel_config_set_read_increment(&cv_dmacfg, true);
+	channel_config_set_write_increment(&cv_dmacfg, false);
+	channel_config_set_dreq(&cv_dmacfg, DREQ_PWM_WRAP0 + slice_num);
+	channel_config_set_chain_to(&cv_dmacfg, cv_dma_ctrl);
+
+	dma_channel_config cv_ctrlcfg = dma_channel_get_default_config(cv_dma_ctrl);
+	channel_config_set_transfer_data_size(&cv_ctrlcfg, DMA_SIZE_32);
+	channel_config_set_read_increment(&cv_ctrlcfg, false);
+	channel_config_set_write_increment(&cv_ctrlcfg, false);
+
+	dma_channel_configure(cv_dma_ctrl, &cv_ctrlcfg, &dma_hw->ch[cv_dma].al3_read_addr_trig, &cvDitherStart, 1, false);
+	dma_channel_configure(cv_dma, &cv_dmacfg, &pwm_hw->slice[slice_num].cc, cvDither, cvDitherLength, true);
+#else
+	// Turn on IRQ for CV output PWM
 	pwm_clear_irq(slice_num);
 	pwm_set_irq_enabled(slice_num, true);
 	
 	irq_set_exclusive_handler(PWM_IRQ_WRAP, ComputerCard::OnCVPWMWrap);
 	irq_set_priority(PWM_IRQ_WRAP, 255);
 	irq_set_enabled(PWM_IRQ_WRAP, true);
+#endif
 
 	
 	// Set up DMA for SPI
@@ -581,10 +784,16 @@ void __not_in_flash_func(ComputerCard::AudioWorker)()
 		}
 		else if (runADCMode == RUN_ADC_MODE_ADC_STOPPED)
 		{
+#ifdef COMPUTERCARD_CV_DMA
+			// Control channel first, so it can't restart the ring
+			dma_channel_cleanup(cv_dma_ctrl);
+			dma_channel_cleanup(cv_dma);
+#else
 			// We can't remove the PWM IRQ from within the ADC IRQ callback, so we do it here instead.
 			irq_set_enabled(PWM_IRQ_WRAP, false);
 			pwm_clear_irq(pwm_gpio_to_slice_num(CV_OUT_1)); // reset CV PWM interrupt flag
 			irq_remove_handler(PWM_IRQ_WRAP, ComputerCard::OnCVPWMWrap);
+#endif
 			break;
 		}
 		   
@@ -597,12 +806,53 @@ void ComputerCard::Abort()
 	runADCMode = RUN_ADC_MODE_REQUEST_ADC_STOP;
 }
 
-void __not_in_flash_func(ComputerCard::CorrectADCDNL)(uint16_t &value) const
+#ifdef COMPUTERCARD_CV_DMA
+// Delta-sigma modulate cvValue[] into the dither ring, as OnCVPWMWrap does
+// per wrap, up to cvDitherLead entries ahead of the DMA read position
+void __not_in_flash_func(ComputerCard::FillCVDither)()
+{
+	static int32_t error1 = 0, error2 = 0;
+	// PWM compare register: channel A in the low half, B in the high half
+	constexpr int shift1 = (CV_OUT_1 & 1) ? 16 : 0;
+	constexpr int shift2 = (CV_OUT_2 & 1) ? 16 : 0;
+
+	uint32_t readPos = (cvDitherLength - dma_hw->ch[cv_dma].transfer_count) & (cvDitherLength - 1);
+	uint32_t ahead = (cvDitherWrite - readPos) & (cvDitherLength - 1);
+	if (ahead > cvDitherLead)
+	{
+		// The DMA overtook the ring (this interrupt was held off); carry on from where it is
+		cvDitherWrite = readPos;
+		ahead = 0;
+	}
+
+	uint32_t cv1 = cvValue[0], cv2 = cvValue[1];
+	for (; ahead < cvDitherLead; ahead++)
+	{
+		uint32_t truncated_cv1_val = (cv1-error1) & 0xFFFFFF00;
+		error1 += truncated_cv1_val - cv1;
+		uint32_t truncated_cv2_val = (cv2-error2) & 0xFFFFFF00;
+		error2 += truncated_cv2_val - cv2;
+		cvDither[cvDitherWrite] = ((truncated_cv1_val>>8) << shift1) | ((truncated_cv2_val>>8) << shift2);
+		cvDitherWrite = (cvDitherWrite + 1) & (cvDitherLength - 1);
+	}
+}
+#endif
+
+uint16_t __not_in_flash_func(ComputerCard::DNLCorrected)(uint16_t value)
 {
 	uint16_t adc512 = value + 512;
 	value += ((value & 0x3FF) == 0x1FF) << 2;
 	value += (adc512 >> 10) << 3;
-	value = uint32_t(value * 520349) >> 19; // Multiply by factor that maps 0-4095 input into 0-4095 output
+	return uint32_t(value * 520349) >> 19; // Multiply by factor that maps 0-4095 input into 0-4095 output
+}
+
+void __not_in_flash_func(ComputerCard::CorrectADCDNL)(uint16_t &value) const
+{
+#ifdef COMPUTERCARD_DNL_LUT
+	value = dnlTable[value & 0xFFF];
+#else
+	value = DNLCorrected(value);
+#endif
 }
 
 // Per-audio-sample ISR, called when two sets of ADC samples have been collected from all four inputs
@@ -611,6 +861,10 @@ void __not_in_flash_func(ComputerCard::BufferFull)()
 	static int startupCounter = 8; // Decreases by 1 each sample, can do startup things when nonzero.
 	static int mux_state = 0;
 	static int norm_probe_count = 0;
+	static int norm_probe_timer = normProbePeriod; // NormProbeScheduled: samples into the period
+	static uint8_t norm_probe_votes[6] = {0,0,0,0,0,0}; // bursts in a row disagreeing with connected[]
+	static bool norm_probe_driving = false; // probe pin toggling, to be driven low when probing stops
+	static bool norm_probe_ran = false; // connected[] has been measured, so disconnected inputs can be zeroed
 
 	// Internal variables for IIR filters on knobs/cv
 	static volatile int32_t knobssm[4] = { 0, 0, 0, 0 };
@@ -645,8 +899,12 @@ void __not_in_flash_func(ComputerCard::BufferFull)()
 	CorrectADCDNL(ADC_Buffer[cpuPhase][1]);
 	CorrectADCDNL(ADC_Buffer[cpuPhase][5]);
 	
+	// The filter keeps running in raw mode, so switching back doesn't jump
 	cvsm[cvi] = (15 * (cvsm[cvi]) + 16 * ADC_Buffer[cpuPhase][7]) >> 4;
-	cv[cvi] = 2048 - (cvsm[cvi] >> 4);
+	if (cvInFilter == CVInRaw)
+		cv[cvi] = 2048 - ADC_Buffer[cpuPhase][7];
+	else
+		cv[cvi] = 2048 - (cvsm[cvi] >> 4);
 
 
 	// Set audio inputs, by averaging the two samples collected.
@@ -661,10 +919,31 @@ void __not_in_flash_func(ComputerCard::BufferFull)()
 	pulse[0] = !gpio_get(PULSE_1_INPUT);
 	pulse[1] = !gpio_get(PULSE_2_INPUT);
 
-	// Set knobs, with ~60Hz LPF
+	// Set knobs. Each knob is read every 4th sample (12kHz), so the fixed
+	// filter here is ~15Hz.
 	int knob = mux_state;
-	knobssm[knob] = (127 * (knobssm[knob]) + 16 * ADC_Buffer[cpuPhase][6]) >> 7;
-	knobs[knob] = knobssm[knob] >> 4;
+	if (knobFilter == KnobAdaptive)
+	{
+		// One-pole whose cutoff follows the distance between the reading and
+		// the filtered value: ~7Hz within 8 LSB (ADC noise), widening to
+		// halving the error every 12kHz step beyond 64 LSB (a knob being turned).
+		// The output then only moves once the filtered value is more than
+		// one LSB from the middle of the current one, so a still knob holds.
+		int32_t err = 16 * ADC_Buffer[cpuPhase][6] - knobssm[knob];
+		int32_t mag = err < 0 ? -err : err;
+		int shift = (mag > 16 * 64) ? 1 : (mag > 16 * 16) ? 3 : (mag > 16 * 8) ? 5 : 8;
+		// Round the step to nearest on both sides of zero; err >> shift
+		// would round toward -inf and pull the filter low
+		int32_t step = (mag + (1 << (shift - 1))) >> shift;
+		knobssm[knob] += (err < 0) ? -step : step;
+		int32_t drift = knobssm[knob] - (knobs[knob] << 4) - 8;
+		if (drift > 16 || drift < -16) knobs[knob] = knobssm[knob] >> 4;
+	}
+	else
+	{
+		knobssm[knob] = (127 * (knobssm[knob]) + 16 * ADC_Buffer[cpuPhase][6]) >> 7;
+		knobs[knob] = knobssm[knob] >> 4;
+	}
 
 	// Set switch value
 	switchVal = static_cast<Switch>((knobs[3]>1000) + (knobs[3]>3000));
@@ -678,8 +957,22 @@ void __not_in_flash_func(ComputerCard::BufferFull)()
 	////////////////////////////
 	// Normalisation probe
 
-	if (useNormProbe)
+	NormProbe probeMode = normProbe;
+	if (probeMode == NormProbeScheduled)
+	{
+		// Probe for the first normProbeBurst samples of each period,
+		// starting on a probe bit boundary
+		if (norm_probe_timer >= normProbePeriod && norm_probe_count == 0) norm_probe_timer = 0;
+		else if (norm_probe_timer < normProbePeriod) norm_probe_timer++;
+	}
+
+	if (probeMode == NormProbeAlways || (probeMode == NormProbeScheduled && norm_probe_timer < normProbeBurst))
 	{
+		// Resuming mid-bit: put back the level np expects for this bit
+		if (!norm_probe_driving) gpio_put(NORMALISATION_PROBE, np & 1);
+		norm_probe_driving = true;
+		norm_probe_ran = true;
+
 		// Set normalisation probe output value
 		// and update np to the expected history string
 		if (norm_probe_count == 0)
@@ -703,12 +996,42 @@ void __not_in_flash_func(ComputerCard::BufferFull)()
 			plug_state[Input::Pulse1] = (plug_state[Input::Pulse1]<<1)+(pulse[0]);
 			plug_state[Input::Pulse2] = (plug_state[Input::Pulse2]<<1)+(pulse[1]);
 
-			for (int i=0; i<6; i++)
+			if (probeMode == NormProbeAlways)
+			{
+				for (int i=0; i<6; i++)
+				{
+					connected[i] = (np != plug_state[i]);
+				}
+			}
+			else if (norm_probe_timer == normProbeBurst - 1)
 			{
-				connected[i] = (np != plug_state[i]);
+				// End of a burst: every bit of history is from this burst.
+				// Change state only when two bursts in a row say so.
+				for (int i=0; i<6; i++)
+				{
+					bool now = (np != plug_state[i]);
+					if (now == connected[i])
+						norm_probe_votes[i] = 0;
+					else if (++norm_probe_votes[i] >= 2)
+					{
+						connected[i] = now;
+						norm_probe_votes[i] = 0;
+					}
+				}
 			}
 		}
-		
+	}
+
+	else if (norm_probe_driving)
+	{
+		// Between bursts, or probe turned off: leave disconnected inputs
+		// normalled to 0V rather than to whichever bit was sent last
+		gpio_put(NORMALISATION_PROBE, 0);
+		norm_probe_driving = false;
+	}
+
+	if (norm_probe_ran)
+	{
 		// Force disconnected values to zero, rather than the normalisation probe garbage
 		if (Disconnected(Input::Audio1)) adcInL = 0;
 		if (Disconnected(Input::Audio2)) adcInR = 0;
@@ -722,6 +1045,10 @@ void __not_in_flash_func(ComputerCard::BufferFull)()
 	// Run the DSP
 	ProcessSample();
 
+#ifdef COMPUTERCARD_CV_DMA
+	FillCVDither();
+#endif
+
 	////////////////////////////////////////
 	// Collect DSP outputs and put them in the DAC SPI buffer
 	// CV/Pulse outputs are done immediately in ProcessSample
@@ -798,18 +1125,27 @@ ComputerCard::HardwareVersion_t ComputerCard::ProbeHardwareVersion()
 
 ComputerCard::ComputerCard()
 {
+	startupTime[StartupEntered] = time_us_32();
+
 	runADCMode = RUN_ADC_MODE_RUNNING;
 
 	adc_run(false);
 	adc_select_input(0);
 
 
-	useNormProbe = false;
+	normProbe = NormProbeOff;
 	for (int i=0; i<6; i++)
 	{
 		connected[i] = false;
 	}
 
+#ifdef COMPUTERCARD_DNL_LUT
+	for (int i=0; i<4096; i++)
+	{
+		dnlTable[i] = DNLCorrected(i);
+	}
+#endif
+
 	
 	////////////////////////////////////////
 	// Initialise LEDs (PWM, set up in pairs due pinout and PWM hardware)
@@ -945,20 +1281,93 @@ ComputerCard::ComputerCard()
 
 	// Read hardware version
 	hw = ProbeHardwareVersion();
+	startupTime[StartupHardware] = time_us_32();
 	
 	// Read EEPROM calibration values
 	cvOutsCalibrated = (ReadEEPROM() == 0);
-	
-	// Read unique card ID
-	flash_get_unique_id((uint8_t *) &uniqueID);
-	// Do some mixing up of the bits using full-cycle 64-bit LCG
-	// Should help ensure most bytes change even if many bits of
-	// the original flash unique ID are the same between flash chips.
-	for (int i=0; i<20; i++)
+	startupTime[StartupCalibration] = time_us_32();
+
+#ifdef COMPUTERCARD_FLASH_CACHE_OFFSET
+	// The cache lives on the same flash chip, so its card ID is current
+	const CalCache *cache = ValidCalCache();
+	if (cache)
+	{
+		uniqueID = cache->uniqueID;
+	}
+	else
+#endif
+	{
+		// Read unique card ID
+		flash_get_unique_id((uint8_t *) &uniqueID);
+		// Do some mixing up of the bits using full-cycle 64-bit LCG
+		// Should help ensure most bytes change even if many bits of
+		// the original flash unique ID are the same between flash chips.
+		for (int i=0; i<20; i++)
+		{
+			uniqueID = uniqueID * 6364136223846793005ULL + 1442695040888963407ULL;
+		}
+	}
+	startupTime[StartupCardID] = time_us_32();
+
+#ifdef COMPUTERCARD_FLASH_CACHE_OFFSET
+	UpdateCalCache(cache);
+#endif
+	startupTime[StartupCacheWrite] = time_us_32();
+}
+
+#ifdef COMPUTERCARD_FLASH_CACHE_OFFSET
+// Return the flash calibration cache, or nullptr if it is missing or corrupt
+const ComputerCard::CalCache *ComputerCard::ValidCalCache()
+{
+	const CalCache *cache = (const CalCache *)(XIP_BASE + COMPUTERCARD_FLASH_CACHE_OFFSET);
+	if (cache->magic != calCacheMagic
+		|| cache->crc != CRCencode((const uint8_t *)cache, offsetof(CalCache, crc)))
+	{
+		return nullptr;
+	}
+	return cache;
+}
+
+// Rewrite the flash calibration cache if it doesn't hold the calibration
+// and card ID now in use. Called from the constructor, before any other
+// core is running code from flash.
+void ComputerCard::UpdateCalCache(const CalCache *cache)
+{
+	static CalCache current;
+	memset(&current, 0, sizeof(current)); // padding is covered by the CRC
+	current.magic = calCacheMagic;
+	current.eepromCRC = eepromCRC;
+	current.eepromValid = cvOutsCalibrated;
+	for (int channel = 0; channel < calMaxChannels; channel++)
 	{
-		uniqueID = uniqueID * 6364136223846793005ULL + 1442695040888963407ULL;
+		int N = numCalibrationPoints[channel];
+		if (N > calMaxPoints) N = calMaxPoints;
+		current.numCalibrationPoints[channel] = N;
+		for (int point = 0; point < N; point++)
+		{
+			current.calibrationTable[channel][point].voltage = calibrationTable[channel][point].voltage;
+			current.calibrationTable[channel][point].dacSetting = calibrationTable[channel][point].dacSetting;
+		}
+	}
+	current.uniqueID = uniqueID;
+	current.crc = CRCencode((const uint8_t *)&current, offsetof(CalCache, crc));
+
+	if (cache && memcmp(cache, &current, sizeof(CalCache)) == 0)
+	{
+		return;
 	}
+
+	static uint8_t page[FLASH_PAGE_SIZE];
+	static_assert(sizeof(CalCache) <= FLASH_PAGE_SIZE, "calibration cache must fit in one page");
+	memset(page, 0xFF, sizeof(page));
+	memcpy(page, &current, sizeof(current));
+
+	uint32_t ints = save_and_disable_interrupts();
+	flash_range_erase(COMPUTERCARD_FLASH_CACHE_OFFSET, FLASH_SECTOR_SIZE);
+	flash_range_program(COMPUTERCARD_FLASH_CACHE_OFFSET, page, FLASH_PAGE_SIZE);
+	restore_interrupts(ints);
 }
+#endif
 
 
 
@@ -1030,7 +1439,9 @@ int ComputerCard::ReadEEPROM()
 		calibrationTable[channel][2].voltage = 20; // +2V
 		calibrationTable[channel][2].dacSetting = 174400;
 		CalcCalCoeffs(channel); // calculate the coefficients
+		CalcCalLookup(channel);
 	}
+	calSource = CalDefault;
 
 	// Read magic number
 	// Failure here could occur if I2C failed, or if incorrect/no magic number stored in EEPROM
@@ -1040,6 +1451,33 @@ int ComputerCard::ReadEEPROM()
 		return 1;
 	}
 
+#ifdef COMPUTERCARD_FLASH_CACHE_OFFSET
+	// If the flash cache was taken from this EEPROM, its CRC is all
+	// that needs reading
+	const CalCache *cache = ValidCalCache();
+	if (cache && cache->eepromValid)
+	{
+		uint16_t foundCRC = ReadIntFromEEPROM(EEPROM_ADDR_CRC_H, i2cFailed);
+		if (!i2cFailed && foundCRC == cache->eepromCRC)
+		{
+			for (uint8_t channel = 0; channel < calMaxChannels; channel++)
+			{
+				numCalibrationPoints[channel] = cache->numCalibrationPoints[channel];
+				for (uint8_t point = 0; point < numCalibrationPoints[channel]; point++)
+				{
+					calibrationTable[channel][point].voltage = cache->calibrationTable[channel][point].voltage;
+					calibrationTable[channel][point].dacSetting = cache->calibrationTable[channel][point].dacSetting;
+				}
+				CalcCalCoeffs(channel);
+				CalcCalLookup(channel);
+			}
+			eepromCRC = foundCRC;
+			calSource = CalFlashCache;
+			return 0;
+		}
+	}
+#endif
+
 	// Read the EEPROM into RAM
 	uint8_t buf[EEPROM_NUM_BYTES];
 	for (int i = 0; i < EEPROM_NUM_BYTES; i++)
@@ -1080,8 +1518,11 @@ int ComputerCard::ReadEEPROM()
 		// Now calculate the calibration coeffs that are actually used
 		// by the calibrated CVOut functions
 		CalcCalCoeffs(channel);
+		CalcCalLookup(channel);
 	}
 
+	eepromCRC = foundCRC;
+	calSource = CalEEPROM;
 	return 0;
 }
 
@@ -1118,6 +1559,56 @@ void ComputerCard::CalcCalCoeffs(int channel)
 	calCoeffs[channel].bi = int32_t(calCoeffs[channel].b + 0.5f);
 }
 
+// Build the piecewise-linear lookup used by CalibratedToDAC.
+// Each node is interpolated between the two calibration points that surround it
+// (extrapolated from the end segments), so the output follows the measured
+// calibration curve rather than only the least-squares line.
+void ComputerCard::CalcCalLookup(int channel)
+{
+	int N = numCalibrationPoints[channel];
+	if (N > calMaxPoints) N = calMaxPoints;
+
+	// Sort calibration points by voltage
+	float v[calMaxPoints], dac[calMaxPoints];
+	for (int i = 0; i < N; i++)
+	{
+		float vi = calibrationTable[channel][i].voltage * 0.1f;
+		float di = calibrationTable[channel][i].dacSetting;
+		int j = i;
+		while (j > 0 && v[j - 1] > vi)
+		{
+			v[j] = v[j - 1];
+			dac[j] = dac[j - 1];
+			j--;
+		}
+		v[j] = vi;
+		dac[j] = di;
+	}
+
+	bool piecewise = (N >= 2);
+	for (int i = 0; i + 1 < N; i++)
+	{
+		if (v[i + 1] == v[i]) piecewise = false; // repeated voltage, fall back to linear fit
+	}
+
+	for (int k = 0; k <= calLookupSize; k++)
+	{
+		float volts = (k - calLookupSize / 2) * 0.375f; // node spacing: 12V / 32
+		float d;
+		if (piecewise)
+		{
+			int seg = 0;
+			while (seg < N - 2 && volts > v[seg + 1]) seg++;
+			d = dac[seg] + (dac[seg + 1] - dac[seg]) * (volts - v[seg]) / (v[seg + 1] - v[seg]);
+		}
+		else
+		{
+			d = calCoeffs[channel].m * volts + calCoeffs[channel].b;
+		}
+		calLookup[channel][k] = int32_t(d + (d < 0 ? -0.5f : 0.5f));
+	}
+}
+
 
 uint32_t ComputerCard::MIDIToDAC(int midiNote, int channel)
 {
@@ -3,7 +3,8 @@
  *
  * Standalone extensions for ComputerCard.h providing:
  * 1. Boot-to-USB functionality (hold switch for 2 seconds)
- * 2. Kodály-inspired startup identification patterns
+ * 2. Kodály-inspired startup identification patterns, played before the
+ *    card starts (default), alongside it, or not at all (see StartupMode)
  *
  * Usage: Just copy this file to your include folder alongside ComputerCard.h
  *
@@ -93,6 +94,16 @@ public:
  * This class uses the inheritance pattern to work around protected access restrictions
  */
 class ExtendedCard : public ComputerCard {
+public:
+    /**
+     * How the startup pattern relates to the card's own processing:
+     * Blocking   ProcessMainSample starts once the pattern has played (3s)
+     * Parallel   ProcessMainSample runs from the first sample; the pattern
+     *            owns the LEDs until it has played
+     * Skip       no pattern, ProcessMainSample from the first sample
+     */
+    enum StartupMode { Blocking, Parallel, Skip };
+
 private:
     // Boot management
     int switchDownCount = 0;
@@ -103,6 +114,7 @@ private:
     int position = 0;
     int sample_counter = 0;
     bool initialization_complete = false;
+    StartupMode startup_mode = Blocking;
 
     /**
      * Handle boot sequence - returns true if should enter bootloader
@@ -182,9 +194,16 @@ protected:
 
     /**
      * Optional: Called once when startup pattern completes
+     * (on the first sample with StartupMode Skip)
      */
     virtual void OnStartupComplete() {}
 
+    /**
+     * Optional: override to run the startup pattern alongside the card,
+     * or skip it. Asked once, on the first sample.
+     */
+    virtual StartupMode GetStartupMode() { return Blocking; }
+
 public:
     ExtendedCard() = default;
 
@@ -195,6 +214,11 @@ public:
         // Initialize startup pattern on first call (after derived constructor completes)
         if (!pattern) {
             pattern = &GetStartupPattern();
+            startup_mode = GetStartupMode();
+            if (startup_mode == Skip) {
+                initialization_complete = true;
+                OnStartupComplete();
+            }
         }
 
         // Handle boot sequence (takes priority over everything)
@@ -207,8 +231,12 @@ public:
             return;
         }
 
-        // Handle startup pattern
+        // Handle startup pattern; in parallel, after the card so the
+        // pattern's LEDs win
         if (!initialization_complete) {
+            if (startup_mode == Parallel) {
+                ProcessMainSample();
+            }
             if (HandleStartupPattern()) {
                 OnStartupComplete();
             }
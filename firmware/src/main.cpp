@@ -1,13 +1,27 @@
+// ComputerCard keeps a copy of the EEPROM calibration and the card ID in
+// the sector below the input calibration profile (INPUT_CAL_FLASH_OFFSET)
+#define COMPUTERCARD_FLASH_CACHE_OFFSET (PICO_FLASH_SIZE_BYTES - 2 * FLASH_SECTOR_SIZE)
+
+#include "BridgeProtocol.h"
 #include "ComputerCard.h"
 #include "ComputerCardExtensions.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
 #include "pico/multicore.h"
 #include "pico/stdlib.h"
+#include <cstddef>
+#include <cstring>
 
 // ---------------------------------------------------------------------------
 // Channel mapping
 // ---------------------------------------------------------------------------
 //
-// Outputs (host → device, 0xC0 packet):
+// Outputs (host → device, 0xC0 packet, 10 bytes):
+//   Byte 0:      0xC0 sync
+//   Byte 1:      flags (bits below)
+//   Bytes 2-9:   4 values, signed 14-bit, two 7-bit bytes each, LSB first
+//                (7-bit like command payloads, so never a sync byte)
+//
 //   ch1 / target[0] → Audio Out 1  (SPI DAC, 12-bit, 48kHz — best for LFO)
 //   ch2 / target[1] → Audio Out 2  (SPI DAC, 12-bit, 48kHz)
 //   ch3 / target[2] → CV Out 1     (PWM, 11-bit, MIDI-calibrated)
@@ -15,9 +29,24 @@
 //   /pulse/1 / flags bit 0 → Pulse Out 1  (GPIO, digital)
 //   /pulse/2 / flags bit 1 → Pulse Out 2  (GPIO, digital)
 //
+// CV Out 1-2 modes (host → device, 0xC2 CMD_SET_CV_MODE):
+//   native      target[2..3] are -2048..+2047, uncalibrated 11-bit (default)
+//   millivolts  target[2..3] are -6000..+6000 mV, calibrated 19-bit
+//   precise     values come from CMD_SET_CV_PRECISE, -262144..+262143,
+//               calibrated 19-bit (~23µV per step)
+// Calibrated modes go through the card's EEPROM calibration table via
+// CVOutCalibrated (precomputed piecewise lookup, no per-sample division).
+//
+// Command packets (host → device, 0xC2, 10 bytes):
+//   Byte 0:      0xC2 sync
+//   Byte 1:      command id
+//   Bytes 2-9:   payload, 7 bits per byte (MSB clear, so payload bytes
+//                can never be mistaken for a sync byte)
+//
 // Inputs (device → host, 0xC1 packet, 16 bytes):
 //   Byte 0:      0xC1 sync
-//   Byte 1:      flags — bit 0: pulse1, bit 1: pulse2, bits 2-3: switch (0/1/2)
+//   Byte 1:      flags — bit 0: pulse1, bit 1: pulse2, bits 2-3: switch (0/1/2),
+//                bits 4-7: report sequence number (mod 16)
 //   Bytes 2-5:   int16_t[2]  CV In 1-2      (-2048..+2047)  → /ch/3-4
 //   Bytes 6-9:   int16_t[2]  Audio In 1-2   (-2048..+2047)  → /ch/1-2
 //   Bytes 10-15: int16_t[3]  Main, X, Y knobs (0-4095)
@@ -25,6 +54,76 @@
 //
 // All values are ComputerCard native range: -2048 to +2047
 // (approx -6V to +6V, 12V span). Voltage conversion is done in Python.
+// With CMD_SET_INPUT_UNITS = millivolts, the CV and audio fields instead
+// carry calibrated millivolts (per-card profile, see Input calibration).
+//
+// Event packets (device → host, 0xC3, 16 bytes):
+//   Byte 0:      0xC3 sync
+//   Byte 1:      event id
+//   Bytes 2-15:  payload (little-endian)
+//
+// Device clock: every CLOCK_EVENT_INTERVAL reports an EVT_CLOCK carries the
+// 48kHz sample count at which the preceding 0xC1 report was taken. Between
+// those, the host counts reports by sequence number (INPUT_REPORT_INTERVAL
+// samples apart), so every report has a device timestamp.
+//
+// Knob filter (host → device, 0xC2 CMD_SET_KNOB_FILTER): smooth is the
+// stock ~15Hz one-pole; adaptive tracks a turning knob within ~1ms and
+// holds a still one steadier (see ComputerCard::SetKnobFilter).
+//
+// CV In filter (host → device, 0xC2 CMD_SET_CV_IN_FILTER): smooth reports
+// the ~240Hz-filtered CV ins as sampled at report time; raw turns the
+// card's filter off (24kHz per input) and reports the mean over the
+// report interval instead: a boxcar decimator, -3dB at ~440Hz, that
+// attenuates what lies above 500Hz rather than aliasing it at full level.
+//
+// Jack detection (host → device, 0xC2 CMD_SET_NORM_PROBE): the
+// normalisation probe runs always (default), once a second, or not at all
+// (jacks keep their last state). The card sends EVT_JACKS whenever a jack
+// is plugged or unplugged, and in reply to the command.
+//
+// Boot times (host → device, 0xC2 CMD_GET_BOOT_TIMES): replies with
+// EVT_BOOT_TIMES, how long each phase of startup took this boot: the
+// ComputerCard constructor's phases (its CV calibration comes from the
+// flash cache unless the EEPROM changed), then the rest of main() up to
+// the first 0xC1 report.
+//
+// Tempo (device → host, 0xC3 EVT_TEMPO): core 1 stamps every Pulse In
+// rising edge with the sample clock, and core 0 estimates the period from
+// the intervals: the median of the last few rejects a missed or doubled
+// pulse, and the intervals that agree with it are averaged for sub-sample
+// resolution. EVT_TEMPO goes out when the estimate moves by more than
+// ~0.01%, and with period 0 once the clock stops, so a steady clock costs
+// next to no USB traffic.
+//
+// Clock processor (host → device, 0xC2 CMD_SET_CLOCK): drives a pulse out
+// from a Pulse In on core 1, with no round trip through the host. Every
+// ÷th input edge starts a bar of × output pulses spread evenly over ÷
+// input periods (so 1/4 divides by four, 4/1 multiplies, 3/2 makes
+// triplets), re-aligned to the input at each bar. Swing (50-99%, 50
+// straight) delays the second, fourth, ... pulse of each bar, never past
+// the expected start of the next, and each pulse fires with the given
+// chance (0-100%) for the given width, shortened to half the pulse
+// spacing if need be. New settings take effect all at once, never half
+// applied. Spacing comes from the tempo estimate, so until that locks
+// only the pulse on the edge fires. The output is high while a clock
+// pulse or trigger runs or its 0xC0 flag bit is set.
+//
+// Scheduled events (host → device, 0xC2 CMD_SCHEDULE): set one output at
+// a given sample clock. Core 0 keeps them sorted and hands each to core 1
+// shortly before it is due; core 1 applies it at the start of that sample.
+// Events already late are applied on the next sample. CMD_CLEAR_SCHEDULE
+// drops every event not yet applied, e.g. when the host exits or connects.
+// Up to 28 events can wait; the last 4 of the 32 slots are kept for
+// CMD_TRIGGER. An event that finds no slot is dropped and reported with
+// EVT_SCHEDULE_FULL.
+//
+// Triggers (host → device, 0xC2 CMD_TRIGGER now, or CMD_SCHEDULE on a
+// trigger channel at a given sample clock): raise a pulse out for a given
+// width. Core 1 times both edges itself, so a single command makes an
+// exact pulse however late the packets after it are. Widths round to whole
+// samples (20.8µs), at least one; a trigger while one is running restarts
+// it. The output is high while a trigger runs or its 0xC0 flag bit is set.
 
 // ---------------------------------------------------------------------------
 // Shared state between cores
@@ -34,28 +133,172 @@
 static volatile int16_t target[4] = {0, 0, 0, 0};
 static volatile uint8_t target_flags = 0; // bit 0: pulse out 1, bit 1: pulse out 2
 
+// Calibrated CV targets (-262144..262143) and per-channel CV Out mode
+static volatile int32_t target_cv_precise[2] = {0, 0};
+static volatile uint8_t cv_mode[2] = {0, 0};
+
+// CV In filter, CV_IN_FILTER_*: written by core 0, read by core 1
+static volatile uint8_t cv_in_filter = CV_IN_FILTER_SMOOTH;
+
 // Input state: written by core 1 (audio ISR), read by core 0 (USB writer)
 static volatile int16_t input_cv[2] = {0, 0};
 static volatile int16_t input_audio[2] = {0, 0};
 static volatile int16_t input_knobs[3] = {0, 0, 0}; // Main, X, Y (0-4095)
 static volatile uint8_t input_flags = 0;
+static volatile uint8_t input_connected = 0; // bit per ComputerCard::Input
+static volatile uint32_t input_sample = 0;   // sample clock when inputs were taken
 static volatile bool inputs_ready = false;
 
+// Pulse In rising edges: written by core 1, read by core 0 (tempo).
+// pulse_edge_seq is odd while core 1 writes pulse_edge_sample and steps
+// by 2 per edge, so core 0 knows the edge count and that the sample it
+// read belongs to it.
+static volatile uint32_t pulse_edge_sample[2] = {0, 0}; // sample clock of the last one
+static volatile uint32_t pulse_edge_seq[2] = {0, 0};
+
+// Pulse In tempo estimate (samples × 256, 0 until locked): written by
+// core 0, read by core 1 (clock processor)
+static volatile uint32_t tempo_period[2] = {0, 0};
+
+// Clock processor settings per pulse out, double-buffered: core 0 fills
+// the slot core 1 isn't reading, then flips clock_config_slot, so core 1
+// always sees one complete configuration. Core 1 echoes the slot it read
+// in clock_config_seen, and core 0 waits for that before refilling the
+// other one, so two changes within a sample can't overwrite a slot in use.
+struct ClockConfig {
+  uint8_t source; // CLOCK_SOURCE_*
+  uint8_t mul;
+  uint8_t div;
+  uint16_t swing;  // delay of odd pulses, spacing × 256
+  uint16_t chance; // out of 256
+  uint32_t width;  // samples
+};
+static ClockConfig clock_config[2][2] = {
+    {{CLOCK_SOURCE_OFF, 1, 1, 0, 256, 480}, {CLOCK_SOURCE_OFF, 1, 1, 0, 256, 480}},
+    {{CLOCK_SOURCE_OFF, 1, 1, 0, 256, 480}, {CLOCK_SOURCE_OFF, 1, 1, 0, 256, 480}}};
+static volatile uint8_t clock_config_slot[2] = {0, 0};
+static volatile uint8_t clock_config_seen[2] = {0, 0};
+
+// Sample clock: samples since boot, written by core 1, wraps after ~24.8h
+static volatile uint32_t sample_clock = 0;
+
+// time_us_32() when the first report was sent (core 0 only)
+static uint32_t boot_first_report_us = 0;
+
+// Input calibration: requested by core 0, measured by core 1.
+// Index order follows ComputerCard::Input (Audio1, Audio2, CV1, CV2).
+static volatile uint8_t input_cal_request = 0; // mask of inputs to calibrate
+static volatile bool input_cal_done = false;
+static volatile int32_t input_cal_sum[2][4];   // [-2V, +2V][input]
+
+// Scheduled events. Core 0 keeps up to SCHEDULE_PENDING sorted by time and
+// moves each into the ring SCHEDULE_HORIZON samples before it is due; core 1
+// scans the (normally one or two) events in the ring every sample.
+struct ScheduledEvent {
+  uint32_t when; // sample clock
+  int32_t value;
+  uint8_t channel; // SCHEDULE_*, or SCHEDULE_DONE once applied
+};
+static constexpr uint8_t SCHEDULE_DONE = 0xFF;
+static constexpr int SCHEDULE_PENDING = 32;
+static constexpr int SCHEDULE_TRIGGER_RESERVE = 4; // of those, only for CMD_TRIGGER
+static constexpr int SCHEDULE_RING = 8; // power of 2
+static constexpr int32_t SCHEDULE_HORIZON = 96; // 2ms, several usb_loop passes
+
+static volatile ScheduledEvent sched_ring[SCHEDULE_RING];
+static volatile uint8_t sched_head = 0; // written by core 0
+static volatile uint8_t sched_tail = 0; // written by core 1
+
 // Input reporting rate in samples (48000 = 1Hz, 480 = 100Hz)
 static constexpr int INPUT_REPORT_INTERVAL = 48; // 1000Hz
 
+// Mean of INPUT_REPORT_INTERVAL samples without dividing: sum * MUL >> 24,
+// MUL rounded to nearest (a 16-bit one truncates 1365.33 and reads low)
+static constexpr int REPORT_MEAN_SHIFT = 24;
+static constexpr int64_t REPORT_MEAN_MUL =
+    ((1 << REPORT_MEAN_SHIFT) + INPUT_REPORT_INTERVAL / 2) / INPUT_REPORT_INTERVAL;
+
+static int16_t report_mean(int32_t sum) {
+  return (int16_t)((sum * REPORT_MEAN_MUL + (1 << (REPORT_MEAN_SHIFT - 1))) >> REPORT_MEAN_SHIFT);
+}
+
+// Reports between EVT_CLOCK events (64ms)
+static constexpr int CLOCK_EVENT_INTERVAL = 64;
+
+// ---------------------------------------------------------------------------
+// Millivolt CV conversion (protocol constants live in BridgeProtocol.h)
+// ---------------------------------------------------------------------------
+
+// Calibrated 19-bit range spans 12V: 1mV = 524288 / 12000 ≈ 43.69 steps,
+// approximated as 44739 / 1024 so core 0 never divides.
+static constexpr int32_t MILLIVOLTS_TO_PRECISE_MUL = 44739;
+static constexpr int MILLIVOLTS_TO_PRECISE_SHIFT = 10;
+
 // ---------------------------------------------------------------------------
-// Binary protocol constants
+// Input calibration
 // ---------------------------------------------------------------------------
+//
+// Patch CV Out 1 → Audio In 1 / CV In 1 and CV Out 2 → Audio In 2 / CV In 2,
+// then send CMD_CALIBRATE_INPUTS. Core 1 drives both calibrated CV outs to
+// -2V then +2V and averages each requested input; core 0 turns the averages
+// into an offset and gain, stores the profile in the last flash sector
+// (keyed by UniqueCardID) and reports it with EVT_INPUT_CAL.
+//
+//   mV = ((native * 16 - offset_q4) * gain_q16) >> 20
+
+static constexpr int NUM_CAL_INPUTS = 4;
+static constexpr int32_t CAL_MILLIVOLTS = 2000;
+static constexpr int CAL_SETTLE_SAMPLES = 2400;  // 50ms for the CV filters to settle
+static constexpr int CAL_AVERAGE_SHIFT = 13;     // average 8192 samples (~170ms)
+static constexpr int CAL_AVERAGE_SAMPLES = 1 << CAL_AVERAGE_SHIFT;
 
-static constexpr uint8_t SYNC_HOST_TO_DEVICE = 0xC0;
-static constexpr uint8_t SYNC_DEVICE_TO_HOST = 0xC1;
-static constexpr int OUTPUT_PACKET_SIZE = 10; // host → device
-static constexpr int INPUT_PACKET_SIZE = 16;  // device → host
+// Nominal gain: 12000mV over 4096 native steps, Q16
+static constexpr int32_t CAL_NOMINAL_GAIN_Q16 = (12000 << 16) / 4096;
+
+// Calibration status codes (EVT_INPUT_CAL)
+static constexpr uint8_t CAL_STATUS_OK = 0;
+static constexpr uint8_t CAL_STATUS_OUT_OF_RANGE = 1; // not patched, or gain >20% off nominal
+static constexpr uint8_t CAL_STATUS_RESET = 2;
+
+static constexpr uint32_t INPUT_CAL_MAGIC = 0x43495357; // "WSIC"
+static constexpr uint32_t INPUT_CAL_FLASH_OFFSET = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE;
+
+// Card settings kept alongside the profile (InputCalProfile::flags)
+static constexpr uint32_t CARD_FLAG_FAST_BOOT = 1 << 0; // skip the startup pattern
+
+struct InputCalProfile {
+  uint32_t magic;
+  uint32_t flags; // CARD_FLAG_*
+  uint64_t cardID;
+  int32_t offset_q4[NUM_CAL_INPUTS];
+  int32_t gain_q16[NUM_CAL_INPUTS];
+  uint16_t crc; // CRCencode over everything above
+};
+
+static InputCalProfile input_cal;
+static uint8_t input_units = INPUT_UNITS_NATIVE;
+
+static void input_cal_set_nominal(int i) {
+  input_cal.offset_q4[i] = 0;
+  input_cal.gain_q16[i] = CAL_NOMINAL_GAIN_Q16;
+}
+
+static int16_t native_to_millivolts(int16_t native, int i, uint8_t connected) {
+  if (!(connected & (1 << i)))
+    return 0;
+  int64_t mv = ((int64_t)(native * 16 - input_cal.offset_q4[i]) * input_cal.gain_q16[i]) >> 20;
+  if (mv < -32768)
+    mv = -32768;
+  if (mv > 32767)
+    mv = 32767;
+  return (int16_t)mv;
+}
 
 // ---------------------------------------------------------------------------
 // Startup pattern: cascade down then "bridge locked" — suggests data flowing
-// through a relay/proxy.
+// through a relay/proxy. It plays while the bridge is already running; fast
+// boot (built with WC_FAST_BOOT, or CMD_SET_BOOT_MODE stored in flash)
+// skips it.
 //
 // LED grid:     0 1       cascade: top → mid → bottom → all on
 //               2 3
@@ -93,38 +336,234 @@ static const CardExtensions::StartupPatterns::Pattern kBridgePattern = {
 class OSCBridge : public CardExtensions::ExtendedCard {
 private:
   int reportCounter = 0;
+  int32_t cvInSum[2] = {0, 0}; // CV In samples since the last report, raw filter only
+  int cvInCount = 0;
+  int calPhase = -1; // -1 idle, 0 measuring at -2V, 1 measuring at +2V
+  int calCounter = 0;
+  uint32_t triggerLeft[2] = {0, 0}; // samples each pulse out stays raised by a trigger
+
+  // Clock processor state per pulse out
+  struct ClockState {
+    uint32_t edges = 0;    // source edges since it was turned on
+    uint32_t barStart = 0; // sample clock of the edge that started this bar
+    uint32_t step = 0;     // samples between output pulses, 0 without a tempo
+    uint32_t swing = 0;    // extra delay of odd pulses, samples
+    uint32_t width = 0;    // samples
+    uint32_t lastDue = 0;  // latest a pulse may start, samples after barStart
+    int pulses = 0;        // output pulses in this bar
+    int next = 0;          // the next one due
+  } clockState[2];
+  uint32_t rng = 0x2545F491; // xorshift32, for the clock processor's chance
+
+  void __not_in_flash_func(RunInputCalibration)() {
+    static constexpr int32_t level[2] = {
+        -CAL_MILLIVOLTS * MILLIVOLTS_TO_PRECISE_MUL >> MILLIVOLTS_TO_PRECISE_SHIFT,
+        CAL_MILLIVOLTS * MILLIVOLTS_TO_PRECISE_MUL >> MILLIVOLTS_TO_PRECISE_SHIFT};
+    CVOutCalibrated(0, level[calPhase]);
+    CVOutCalibrated(1, level[calPhase]);
+
+    if (calCounter >= CAL_SETTLE_SAMPLES) {
+      volatile int32_t *sum = input_cal_sum[calPhase];
+      sum[Audio1] += AudioIn1();
+      sum[Audio2] += AudioIn2();
+      sum[CV1] += CVIn1();
+      sum[CV2] += CVIn2();
+    }
+
+    if (++calCounter == CAL_SETTLE_SAMPLES + CAL_AVERAGE_SAMPLES) {
+      calCounter = 0;
+      if (++calPhase == 2) {
+        calPhase = -1;
+        input_cal_done = true;
+      }
+    }
+  }
+
+  // Clock processor for pulse out i: start a bar on every ÷th source
+  // edge, then raise the output for each of its pulses as it falls due
+  void __not_in_flash_func(RunClock)(int i, uint32_t now) {
+    ClockState &c = clockState[i];
+    uint8_t slot = clock_config_slot[i];
+    clock_config_seen[i] = slot;
+    const ClockConfig &cfg = clock_config[i][slot];
+    if (cfg.source == CLOCK_SOURCE_OFF) {
+      c.edges = 0;
+      c.pulses = c.next = 0;
+      return;
+    }
+    int in = cfg.source - CLOCK_SOURCE_PULSE_IN1;
+    if (PulseInRisingEdge(in) && c.edges++ % cfg.div == 0) {
+      // Start of a bar; a pulse still due from the last one is dropped.
+      // 64-bit, but only once a bar.
+      uint64_t bar = (uint64_t)tempo_period[in] * cfg.div; // samples × 256
+      c.barStart = now;
+      c.step = (uint32_t)((bar / cfg.mul) >> 8);
+      c.swing = (uint32_t)(((uint64_t)c.step * cfg.swing) >> 8);
+      c.pulses = c.step ? cfg.mul : 1;
+      c.next = 0;
+      c.width = cfg.width;
+      if (c.step && c.width > c.step / 2)
+        c.width = c.step > 1 ? c.step / 2 : 1;
+      // A swung pulse must be over before the next bar is expected to start
+      c.lastDue = c.step * c.pulses > c.width ? c.step * c.pulses - c.width : 0;
+    }
+    if (c.next < c.pulses) {
+      uint32_t due = c.next * c.step + ((c.next & 1) ? c.swing : 0);
+      if (due > c.lastDue)
+        due = c.lastDue;
+      if (now - c.barStart >= due) {
+        c.next++;
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        if ((rng & 0xFF) < cfg.chance)
+          triggerLeft[i] = c.width;
+      }
+    }
+  }
+
+  // Apply every handed-over event that is due, then drop applied events
+  // from the front of the ring
+  void __not_in_flash_func(RunScheduledEvents)(uint32_t now) {
+    uint8_t tail = sched_tail;
+    uint8_t head = sched_head;
+    for (uint8_t i = tail; i != head; i = (i + 1) & (SCHEDULE_RING - 1)) {
+      volatile ScheduledEvent &e = sched_ring[i];
+      uint8_t ch = e.channel;
+      if (ch == SCHEDULE_DONE || (int32_t)(now - e.when) < 0)
+        continue;
+      int32_t v = e.value;
+      switch (ch) {
+      case SCHEDULE_AUDIO_OUT1:
+      case SCHEDULE_AUDIO_OUT2:
+        target[ch] = (int16_t)v;
+        break;
+      case SCHEDULE_CV_OUT1:
+      case SCHEDULE_CV_OUT2:
+        if (cv_mode[ch - SCHEDULE_CV_OUT1] == CV_MODE_NATIVE)
+          target[ch] = (int16_t)v;
+        else
+          target_cv_precise[ch - SCHEDULE_CV_OUT1] = v;
+        break;
+      case SCHEDULE_PULSE_OUT1:
+      case SCHEDULE_PULSE_OUT2: {
+        uint8_t bit = 1 << (ch - SCHEDULE_PULSE_OUT1);
+        target_flags = v ? (target_flags | bit) : (target_flags & ~bit);
+        break;
+      }
+      case SCHEDULE_TRIGGER_OUT1:
+      case SCHEDULE_TRIGGER_OUT2:
+        triggerLeft[ch - SCHEDULE_TRIGGER_OUT1] = v; // samples, converted by core 0
+        break;
+      }
+      e.channel = SCHEDULE_DONE;
+    }
+    while (tail != head && sched_ring[tail].channel == SCHEDULE_DONE)
+      tail = (tail + 1) & (SCHEDULE_RING - 1);
+    __dmb(); // done with the slots before core 0 can refill them
+    sched_tail = tail;
+  }
 
 protected:
   const CardExtensions::StartupPatterns::Pattern &GetStartupPattern() override {
     return kBridgePattern;
   }
 
+  StartupMode GetStartupMode() override {
+#ifdef WC_FAST_BOOT
+    return Skip;
+#else
+    return (input_cal.flags & CARD_FLAG_FAST_BOOT) ? Skip : Parallel;
+#endif
+  }
+
   void __not_in_flash_func(ProcessMainSample)() override {
+    uint32_t now = sample_clock + 1;
+    sample_clock = now;
+    if (sched_head != sched_tail)
+      RunScheduledEvents(now);
+
     // Apply target values to outputs — pure integer, no scaling
     AudioOut1(target[0]);
     AudioOut2(target[1]);
-    CVOut1(target[2]);
-    CVOut2(target[3]);
+    int32_t level[4] = {target[0], target[1], target[2], target[3]};
+
+    // Input calibration takes over both CV outs while it runs
+    if (calPhase < 0 && input_cal_request) {
+      input_cal_request = 0;
+      for (int i = 0; i < NUM_CAL_INPUTS; i++) {
+        input_cal_sum[0][i] = 0;
+        input_cal_sum[1][i] = 0;
+      }
+      calPhase = 0;
+      calCounter = 0;
+    }
+    if (calPhase >= 0)
+      RunInputCalibration();
+
+    for (int i = 0; i < 2 && calPhase < 0; i++) {
+      if (cv_mode[i] == CV_MODE_NATIVE) {
+        CVOut(i, target[2 + i]);
+      } else {
+        int32_t p = target_cv_precise[i];
+        CVOutCalibrated(i, p);
+        level[2 + i] = p >> 7; // back to native scale for the LED
+      }
+    }
     uint8_t f = target_flags;
+    for (int i = 0; i < 2; i++) {
+      RunClock(i, now);
+      if (triggerLeft[i]) {
+        triggerLeft[i]--;
+        f |= 1 << i;
+      }
+    }
     PulseOut1(f & 0x01);
     PulseOut2((f & 0x02) != 0);
 
     // Per-channel activity LEDs: brightness tracks |voltage|
-    // target range is -2048..+2047, LED brightness is 0..4095
+    // level range is -2048..+2047, LED brightness is 0..4095
     for (int i = 0; i < 4; i++) {
-      int32_t v = target[i];
+      int32_t v = level[i];
       if (v < 0)
         v = -v;
+      if (v > 2047)
+        v = 2047;
       LedBrightness(i, (uint16_t)(v * 2));
     }
 
-    // Sample inputs at configured rate
+    // Stamp clock edges for the tempo estimate (core 0)
+    for (int i = 0; i < 2; i++) {
+      if (PulseInRisingEdge(i)) {
+        pulse_edge_seq[i]++;
+        __dmb();
+        pulse_edge_sample[i] = now;
+        __dmb();
+        pulse_edge_seq[i]++;
+      }
+    }
+
+    // Sample inputs at configured rate. Raw CV In reports the mean over
+    // the interval; one switched to raw part way through reports as is.
+    bool cvRaw = cv_in_filter == CV_IN_FILTER_RAW;
+    if (cvRaw) {
+      cvInSum[0] += CVIn1();
+      cvInSum[1] += CVIn2();
+      cvInCount++;
+    }
     reportCounter++;
     if (reportCounter >= INPUT_REPORT_INTERVAL) {
       reportCounter = 0;
 
-      input_cv[0] = Connected(CV1) ? CVIn1() : 0;
-      input_cv[1] = Connected(CV2) ? CVIn2() : 0;
+      int16_t cv0 = CVIn1(), cv1 = CVIn2();
+      if (cvRaw && cvInCount == INPUT_REPORT_INTERVAL) {
+        cv0 = report_mean(cvInSum[0]);
+        cv1 = report_mean(cvInSum[1]);
+      }
+      cvInSum[0] = cvInSum[1] = 0;
+      cvInCount = 0;
+      input_cv[0] = Connected(CV1) ? cv0 : 0;
+      input_cv[1] = Connected(CV2) ? cv1 : 0;
       input_audio[0] = Connected(Audio1) ? AudioIn1() : 0;
       input_audio[1] = Connected(Audio2) ? AudioIn2() : 0;
       input_knobs[0] = (int16_t)KnobVal(Main);
@@ -133,19 +572,492 @@ protected:
       uint8_t p1 = Connected(Pulse1) ? (PulseIn1() ? 0x01 : 0x00) : 0x00;
       uint8_t p2 = Connected(Pulse2) ? (PulseIn2() ? 0x02 : 0x00) : 0x00;
       input_flags = p1 | p2 | ((uint8_t)SwitchVal() << 2);
+      uint8_t conn = 0;
+      for (int i = 0; i < 6; i++)
+        conn |= Connected((Input)i) << i;
+      input_connected = conn;
+      input_sample = now;
       inputs_ready = true;
     }
   }
 
 public:
   OSCBridge() { EnableNormalisationProbe(); }
+
+  uint64_t CardID() const { return UniqueCardID(); }
+  CalSource CalibrationSource() const { return CVOutsCalibrationSource(); }
+  uint32_t BootTime(StartupPhase phase) const { return StartupTime(phase); }
+
+  // Load this card's input calibration profile (and settings) from flash, or
+  // nominal values if there is none (or it was written by a different card).
+  void LoadInputCalibration() {
+    const InputCalProfile *stored =
+        (const InputCalProfile *)(XIP_BASE + INPUT_CAL_FLASH_OFFSET);
+    if (stored->magic == INPUT_CAL_MAGIC && stored->cardID == UniqueCardID() &&
+        stored->crc == CRCencode((const uint8_t *)stored, offsetof(InputCalProfile, crc))) {
+      input_cal = *stored;
+      return;
+    }
+    input_cal.magic = INPUT_CAL_MAGIC;
+    input_cal.flags = 0;
+    input_cal.cardID = UniqueCardID();
+    for (int i = 0; i < NUM_CAL_INPUTS; i++)
+      input_cal_set_nominal(i);
+  }
+
+  // Write the current profile to flash. Core 1 is parked in RAM (multicore
+  // lockout) for the ~50ms sector erase, so audio pauses briefly.
+  void SaveInputCalibration() {
+    input_cal.crc = CRCencode((const uint8_t *)&input_cal, offsetof(InputCalProfile, crc));
+
+    static uint8_t page[FLASH_PAGE_SIZE];
+    static_assert(sizeof(InputCalProfile) <= FLASH_PAGE_SIZE, "profile must fit in one page");
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &input_cal, sizeof(input_cal));
+
+    multicore_lockout_start_blocking();
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(INPUT_CAL_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(INPUT_CAL_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+    restore_interrupts(ints);
+    multicore_lockout_end_blocking();
+  }
 };
 
 // Pointer for core 1 to access the bridge instance constructed in main().
 static OSCBridge *bridge_ptr = nullptr;
 
 // Core 1 entry: runs audio pipeline (blocks forever)
-static void core1_audio_entry() { bridge_ptr->RunWithBootSupport(); }
+static void core1_audio_entry() {
+  // Lets core 0 park this core in RAM while it writes calibration to flash
+  multicore_lockout_victim_init();
+  bridge_ptr->RunWithBootSupport();
+}
+
+// ---------------------------------------------------------------------------
+// Event packets (core 0)
+// ---------------------------------------------------------------------------
+
+static void put_le32(uint8_t *p, int32_t v) {
+  p[0] = (uint8_t)(v & 0xFF);
+  p[1] = (uint8_t)((v >> 8) & 0xFF);
+  p[2] = (uint8_t)((v >> 16) & 0xFF);
+  p[3] = (uint8_t)((v >> 24) & 0xFF);
+}
+
+static void send_event(uint8_t id, const uint8_t *payload, int len) {
+  uint8_t pkt[INPUT_PACKET_SIZE] = {SYNC_DEVICE_EVENT, id};
+  for (int i = 0; i < len && i < INPUT_PACKET_SIZE - 2; i++)
+    pkt[2 + i] = payload[i];
+  for (int i = 0; i < INPUT_PACKET_SIZE; i++)
+    putchar_raw(pkt[i]);
+}
+
+static void send_card_info_event() {
+  uint64_t id = bridge_ptr->CardID();
+  uint8_t payload[9];
+  put_le32(&payload[0], (int32_t)(id & 0xFFFFFFFF));
+  put_le32(&payload[4], (int32_t)(id >> 32));
+  payload[8] = PROTOCOL_VERSION;
+  send_event(EVT_CARD_INFO, payload, sizeof(payload));
+}
+
+// Which inputs are patched, and which changed since the last EVT_JACKS.
+// Starts as no valid mask, so the first report always sends one.
+static uint8_t jacks_sent = 0xFF;
+
+static void send_jacks_event(uint8_t connected) {
+  uint8_t payload[2] = {connected, (uint8_t)((connected ^ jacks_sent) & 0x3F)};
+  jacks_sent = connected;
+  send_event(EVT_JACKS, payload, sizeof(payload));
+}
+
+// Startup phase durations: source of the CV Out calibration, then µs
+// (saturating) from reset to the constructor and for each of its phases,
+// then ms from reset to the first report
+static void put_le16_sat(uint8_t *p, uint32_t v) {
+  if (v > 0xFFFF)
+    v = 0xFFFF;
+  p[0] = (uint8_t)(v & 0xFF);
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static_assert(ComputerCard::CalDefault == CAL_SOURCE_DEFAULT && ComputerCard::CalEEPROM == CAL_SOURCE_EEPROM &&
+                  ComputerCard::CalFlashCache == CAL_SOURCE_FLASH_CACHE,
+              "EVT_BOOT_TIMES sources follow ComputerCard::CalSource");
+
+static void send_boot_times_event() {
+  uint8_t payload[13];
+  payload[0] = (uint8_t)bridge_ptr->CalibrationSource();
+  put_le16_sat(&payload[1], bridge_ptr->BootTime(ComputerCard::StartupEntered));
+  for (int i = 1; i < ComputerCard::NumStartupPhases; i++) {
+    put_le16_sat(&payload[1 + 2 * i], bridge_ptr->BootTime((ComputerCard::StartupPhase)i) -
+                                          bridge_ptr->BootTime((ComputerCard::StartupPhase)(i - 1)));
+  }
+  put_le16_sat(&payload[11], boot_first_report_us / 1000);
+  send_event(EVT_BOOT_TIMES, payload, sizeof(payload));
+}
+
+// Sample clock of the report just sent, and its sequence number
+static void send_clock_event(uint32_t sample, uint8_t seq) {
+  uint8_t payload[5];
+  put_le32(&payload[0], (int32_t)sample);
+  payload[4] = seq;
+  send_event(EVT_CLOCK, payload, sizeof(payload));
+}
+
+static void send_input_cal_event(int i, uint8_t status) {
+  uint8_t payload[10];
+  payload[0] = (uint8_t)i;
+  payload[1] = status;
+  put_le32(&payload[2], input_cal.offset_q4[i]);
+  put_le32(&payload[6], input_cal.gain_q16[i]);
+  send_event(EVT_INPUT_CAL, payload, sizeof(payload));
+}
+
+// Turn the averages collected by core 1 into offsets and gains
+static uint8_t input_cal_mask = 0;
+
+static void finish_input_calibration() {
+  bool changed = false;
+  for (int i = 0; i < NUM_CAL_INPUTS; i++) {
+    if (!(input_cal_mask & (1 << i)))
+      continue;
+
+    // Averages in Q4 (1/16 native step)
+    int32_t lo_q4 = input_cal_sum[0][i] >> (CAL_AVERAGE_SHIFT - 4);
+    int32_t hi_q4 = input_cal_sum[1][i] >> (CAL_AVERAGE_SHIFT - 4);
+    int32_t span_q4 = hi_q4 - lo_q4;
+
+    // 4V should span ~1365 native steps; reject anything 20% off
+    int32_t nominal_q4 = (2 * CAL_MILLIVOLTS * 16 * 4096) / 12000;
+    if (span_q4 < nominal_q4 * 4 / 5 || span_q4 > nominal_q4 * 6 / 5) {
+      send_input_cal_event(i, CAL_STATUS_OUT_OF_RANGE);
+      continue;
+    }
+
+    input_cal.offset_q4[i] = (lo_q4 + hi_q4) / 2;
+    input_cal.gain_q16[i] = (int32_t)(((int64_t)(2 * CAL_MILLIVOLTS) << 20) / span_q4);
+    changed = true;
+    send_input_cal_event(i, CAL_STATUS_OK);
+  }
+  if (changed)
+    bridge_ptr->SaveInputCalibration();
+}
+
+// ---------------------------------------------------------------------------
+// Scheduled events (core 0)
+// ---------------------------------------------------------------------------
+
+static ScheduledEvent sched_pending[SCHEDULE_PENDING]; // sorted by when
+static int sched_pending_count = 0;
+
+// Trigger width in µs to whole samples, at least one
+static int32_t trigger_samples(int32_t us) {
+  int32_t n = us > 0 ? (us * 48 + 500) / 1000 : 0;
+  return n > 0 ? n : 1;
+}
+
+// Events dropped because the queue was full, reported with EVT_SCHEDULE_FULL
+static uint32_t sched_dropped = 0;
+
+static void send_schedule_full_event(uint8_t channel) {
+  uint8_t payload[5];
+  payload[0] = channel;
+  put_le32(&payload[1], (int32_t)sched_dropped);
+  send_event(EVT_SCHEDULE_FULL, payload, sizeof(payload));
+}
+
+// Insert in time order, if fewer than limit are pending; otherwise dropped
+// and reported. CMD_SCHEDULE leaves SCHEDULE_TRIGGER_RESERVE slots free, so
+// a queue full of future events can't hold back an immediate trigger.
+static void schedule_event(uint32_t when28, uint8_t channel, int32_t value,
+                           int limit = SCHEDULE_PENDING - SCHEDULE_TRIGGER_RESERVE) {
+  if (channel > SCHEDULE_TRIGGER_OUT2)
+    return;
+  if (sched_pending_count >= limit) {
+    sched_dropped++;
+    send_schedule_full_event(channel);
+    return;
+  }
+  if (channel >= SCHEDULE_TRIGGER_OUT1)
+    value = trigger_samples(value);
+  // Widen the 28-bit time to the sample clock closest to now
+  uint32_t now = sample_clock;
+  int32_t ahead = (int32_t)((when28 - now) << 4) >> 4;
+  ScheduledEvent ev = {now + ahead, value, channel};
+
+  int i = sched_pending_count++;
+  while (i > 0 && (int32_t)(sched_pending[i - 1].when - ev.when) > 0) {
+    sched_pending[i] = sched_pending[i - 1];
+    i--;
+  }
+  sched_pending[i] = ev;
+}
+
+// Drop every event not yet applied. Core 1 may apply one of those in the
+// ring meanwhile; it marks it done as well, so either way it runs once.
+static void clear_schedule() {
+  sched_pending_count = 0;
+  for (uint8_t i = sched_tail; i != sched_head; i = (i + 1) & (SCHEDULE_RING - 1))
+    sched_ring[i].channel = SCHEDULE_DONE;
+}
+
+// Hand events due within SCHEDULE_HORIZON over to core 1
+static void __not_in_flash_func(service_schedule)() {
+  int n = 0;
+  uint32_t now = sample_clock;
+  while (n < sched_pending_count && (int32_t)(sched_pending[n].when - now) < SCHEDULE_HORIZON) {
+    uint8_t head = sched_head;
+    uint8_t next = (head + 1) & (SCHEDULE_RING - 1);
+    if (next == sched_tail)
+      break; // ring full, try again next pass
+    volatile ScheduledEvent &slot = sched_ring[head];
+    slot.when = sched_pending[n].when;
+    slot.value = sched_pending[n].value;
+    slot.channel = sched_pending[n].channel;
+    __dmb(); // the event lands before core 1 can see it
+    sched_head = next;
+    n++;
+  }
+  if (n == 0)
+    return;
+  sched_pending_count -= n;
+  for (int i = 0; i < sched_pending_count; i++)
+    sched_pending[i] = sched_pending[i + n];
+}
+
+// ---------------------------------------------------------------------------
+// Pulse In tempo (core 0)
+// ---------------------------------------------------------------------------
+
+static constexpr int TEMPO_HISTORY = 5;                // intervals in the median
+static constexpr int TEMPO_LOCK = 3;                   // intervals before the first estimate
+static constexpr uint32_t TEMPO_MIN_INTERVAL = 48;     // 1ms: shorter is bounce, not a clock
+static constexpr uint32_t TEMPO_MAX_INTERVAL = 480000; // 10s: longer is a stopped clock
+
+struct TempoTracker {
+  uint32_t seq;        // pulse_edge_seq last taken from core 1
+  uint32_t lastEdge;   // sample clock
+  bool haveEdge;       // lastEdge starts an interval
+  uint32_t history[TEMPO_HISTORY];
+  int intervals;       // valid entries in history
+  int next;
+  uint32_t period;     // samples × 256, 0 until locked
+  uint32_t sent;       // period in the last EVT_TEMPO
+};
+static TempoTracker tempo[2];
+
+static uint32_t tempo_median(const TempoTracker &t) {
+  uint32_t v[TEMPO_HISTORY];
+  for (int i = 0; i < t.intervals; i++) {
+    int j = i;
+    for (; j > 0 && v[j - 1] > t.history[i]; j--)
+      v[j] = v[j - 1];
+    v[j] = t.history[i];
+  }
+  return v[t.intervals / 2];
+}
+
+// Clock stopped: forget it, so a restart locks afresh at its own tempo
+static void tempo_reset(TempoTracker &t) {
+  t.haveEdge = false;
+  t.intervals = 0;
+  t.next = 0;
+  t.period = 0;
+}
+
+static void tempo_edge(TempoTracker &t, uint32_t edge) {
+  uint32_t interval = edge - t.lastEdge;
+  if (t.haveEdge && interval < TEMPO_MIN_INTERVAL)
+    return;
+  if (t.haveEdge && interval > TEMPO_MAX_INTERVAL)
+    tempo_reset(t);
+  bool start = !t.haveEdge;
+  t.lastEdge = edge;
+  t.haveEdge = true;
+  if (start)
+    return;
+
+  t.history[t.next] = interval;
+  t.next = (t.next + 1) % TEMPO_HISTORY;
+  if (t.intervals < TEMPO_HISTORY)
+    t.intervals++;
+  if (t.intervals < TEMPO_LOCK)
+    return;
+
+  // Lock to the median, and follow it when the tempo changes; otherwise
+  // average in the intervals near it, 1/8 each
+  int32_t median = (int32_t)tempo_median(t) << 8;
+  int32_t drift = median - (int32_t)t.period;
+  int32_t error = (int32_t)(interval << 8) - (int32_t)t.period;
+  if (!t.period || drift > (int32_t)(t.period >> 5) || -drift > (int32_t)(t.period >> 5))
+    t.period = median;
+  else if (error <= median >> 4 && -error <= median >> 4)
+    t.period += error / 8;
+}
+
+static void send_tempo_event(int input, const TempoTracker &t) {
+  uint8_t payload[9];
+  payload[0] = (uint8_t)input;
+  put_le32(&payload[1], (int32_t)t.period);
+  put_le32(&payload[5], (int32_t)t.lastEdge);
+  send_event(EVT_TEMPO, payload, sizeof(payload));
+}
+
+// Take new edges from core 1; report changes, and clocks that stopped
+static void service_tempo() {
+  for (int i = 0; i < 2; i++) {
+    TempoTracker &t = tempo[i];
+    uint32_t seq = pulse_edge_seq[i];
+    if (seq != t.seq) {
+      if (seq & 1)
+        continue; // core 1 is stamping one; take it next pass
+      __dmb();
+      uint32_t edge = pulse_edge_sample[i];
+      __dmb();
+      if (pulse_edge_seq[i] != seq)
+        continue; // and another meanwhile
+      if (seq - t.seq != 2)
+        t.haveEdge = false; // missed one, so no interval to measure
+      t.seq = seq;
+      tempo_edge(t, edge);
+      tempo_period[i] = t.period;
+    } else if (t.haveEdge) {
+      // Stopped once no edge comes for two periods
+      uint32_t timeout = t.period ? t.period >> 7 : TEMPO_MAX_INTERVAL;
+      if (sample_clock - t.lastEdge > timeout) {
+        tempo_reset(t);
+        tempo_period[i] = 0;
+      }
+    }
+
+    uint32_t diff = t.period > t.sent ? t.period - t.sent : t.sent - t.period;
+    if (t.period ? (!t.sent || diff > t.sent >> 13) : t.sent) {
+      t.sent = t.period;
+      send_tempo_event(i, t);
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Host command handling (core 0)
+// ---------------------------------------------------------------------------
+
+static int32_t millivolts_to_precise(int32_t mv) {
+  if (mv < -6000)
+    mv = -6000;
+  if (mv > 6000)
+    mv = 6000;
+  return (mv * MILLIVOLTS_TO_PRECISE_MUL) >> MILLIVOLTS_TO_PRECISE_SHIFT;
+}
+
+static void handle_command(const uint8_t *pkt) {
+  if (!payload_is_valid(pkt))
+    return;
+  const uint8_t *d = &pkt[2];
+
+  switch (pkt[1]) {
+  case CMD_SET_CV_MODE:
+    for (int i = 0; i < 2; i++) {
+      uint8_t mode = d[i];
+      if (mode > CV_MODE_PRECISE)
+        continue;
+      // Start a calibrated channel from the current native target so the
+      // output doesn't jump before the first value in the new mode arrives
+      if (mode != CV_MODE_NATIVE && cv_mode[i] == CV_MODE_NATIVE)
+        target_cv_precise[i] = (int32_t)target[2 + i] << 7;
+      cv_mode[i] = mode;
+    }
+    break;
+  case CMD_SET_CV_PRECISE:
+    target_cv_precise[0] = unpack_s21(&d[0]);
+    target_cv_precise[1] = unpack_s21(&d[3]);
+    break;
+  case CMD_CALIBRATE_INPUTS:
+    input_cal_mask = d[0] & 0x0F;
+    if (input_cal_mask)
+      input_cal_request = input_cal_mask;
+    break;
+  case CMD_SET_INPUT_UNITS:
+    if (d[0] <= INPUT_UNITS_MILLIVOLTS)
+      input_units = d[0];
+    break;
+  case CMD_RESET_INPUT_CAL:
+    for (int i = 0; i < NUM_CAL_INPUTS; i++) {
+      if (d[0] & (1 << i)) {
+        input_cal_set_nominal(i);
+        send_input_cal_event(i, CAL_STATUS_RESET);
+      }
+    }
+    if (d[0] & 0x0F)
+      bridge_ptr->SaveInputCalibration();
+    break;
+  case CMD_SCHEDULE:
+    schedule_event(unpack_u28(&d[0]), d[4], unpack_s21(&d[5]));
+    break;
+  case CMD_TRIGGER:
+    if (d[0] <= 1)
+      schedule_event(sample_clock, SCHEDULE_TRIGGER_OUT1 + d[0], unpack_u21(&d[1]), SCHEDULE_PENDING);
+    break;
+  case CMD_SET_CLOCK:
+    if (d[0] <= 1 && d[1] <= CLOCK_SOURCE_PULSE_IN2 && d[2] && d[3]) {
+      int i = d[0];
+      while (clock_config_seen[i] != clock_config_slot[i])
+        ; // core 1 may still be reading the other slot; at most a sample
+      uint8_t slot = clock_config_slot[i] ^ 1;
+      ClockConfig &cfg = clock_config[i][slot];
+      uint32_t swing = d[4] > 50 ? (d[4] < 99 ? d[4] : 99) - 50 : 0;
+      uint32_t chance = d[5] < 100 ? d[5] : 100;
+      cfg.source = d[1];
+      cfg.mul = d[2];
+      cfg.div = d[3];
+      cfg.swing = (uint16_t)((swing << 9) / 100); // (s - 50) / 50 of the spacing
+      cfg.chance = (uint16_t)((chance << 8) / 100);
+      cfg.width = trigger_samples((d[6] | (d[7] << 7)) * 100);
+      __dmb(); // settings land before core 1 can see the slot
+      clock_config_slot[i] = slot;
+    }
+    break;
+  case CMD_CLEAR_SCHEDULE:
+    clear_schedule();
+    break;
+  case CMD_GET_CARD_INFO:
+    send_card_info_event();
+    break;
+  case CMD_SET_KNOB_FILTER:
+    if (d[0] <= KNOB_FILTER_ADAPTIVE)
+      bridge_ptr->SetKnobFilter((ComputerCard::KnobFilter)d[0]);
+    break;
+  case CMD_SET_NORM_PROBE:
+    if (d[0] <= NORM_PROBE_SCHEDULED)
+      bridge_ptr->SetNormalisationProbe((ComputerCard::NormProbe)d[0]);
+    if (input_sample) // else the first report will
+      send_jacks_event(input_connected);
+    break;
+  case CMD_SET_BOOT_MODE:
+    if (d[0] <= BOOT_MODE_FAST) {
+      uint32_t flags = d[0] == BOOT_MODE_FAST ? (input_cal.flags | CARD_FLAG_FAST_BOOT)
+                                              : (input_cal.flags & ~CARD_FLAG_FAST_BOOT);
+      if (flags != input_cal.flags) {
+        input_cal.flags = flags;
+        bridge_ptr->SaveInputCalibration();
+      }
+    }
+    break;
+  case CMD_GET_BOOT_TIMES:
+    send_boot_times_event();
+    break;
+  case CMD_SET_CV_IN_FILTER:
+    if (d[0] <= CV_IN_FILTER_RAW) {
+      cv_in_filter = d[0];
+      bridge_ptr->SetCVInFilter((ComputerCard::CVInFilter)d[0]);
+    }
+    break;
+  default:
+    break;
+  }
+}
 
 // ---------------------------------------------------------------------------
 // Core 0: USB CDC reader/writer (main thread)
@@ -155,38 +1067,39 @@ static void core1_audio_entry() { bridge_ptr->RunWithBootSupport(); }
 // another core silently gets nothing.
 
 static void __not_in_flash_func(usb_loop)() {
-  uint8_t pktBuf[OUTPUT_PACKET_SIZE];
-  uint8_t pktPos = 0;
+  PacketParser parser;
+  int clockCounter = 0;
 
   while (true) {
     // --- Read incoming packets from host ---
     int c = getchar_timeout_us(100);
-    if (c != PICO_ERROR_TIMEOUT) {
-      uint8_t b = (uint8_t)c;
-
-      // Resync: if we're mid-packet and see a sync byte, restart
-      if (pktPos > 0 && b == SYNC_HOST_TO_DEVICE) {
-        pktBuf[0] = b;
-        pktPos = 1;
-        continue;
+    if (c != PICO_ERROR_TIMEOUT && parse_byte(parser, (uint8_t)c)) {
+      if (parser.buf[0] == SYNC_HOST_COMMAND) {
+        handle_command(parser.buf);
+      } else if (payload_is_valid(parser.buf)) {
+        // Complete packet — copy to targets
+        OutputPacket pkt = decode_output_packet(parser.buf);
+        target_flags = pkt.flags;
+        target[0] = pkt.values[0];
+        target[1] = pkt.values[1];
+        for (int i = 0; i < 2; i++) {
+          if (cv_mode[i] == CV_MODE_MILLIVOLTS)
+            target_cv_precise[i] = millivolts_to_precise(pkt.values[2 + i]);
+          else
+            target[2 + i] = pkt.values[2 + i];
+        }
       }
+    }
 
-      // Wait for sync byte to start a packet
-      if (pktPos == 0 && b != SYNC_HOST_TO_DEVICE) {
-        continue;
-      }
+    if (sched_pending_count)
+      service_schedule();
 
-      pktBuf[pktPos++] = b;
+    service_tempo();
 
-      if (pktPos == OUTPUT_PACKET_SIZE) {
-        // Complete packet — copy to targets
-        target_flags = pktBuf[1];
-        target[0] = (int16_t)(pktBuf[2] | (pktBuf[3] << 8));
-        target[1] = (int16_t)(pktBuf[4] | (pktBuf[5] << 8));
-        target[2] = (int16_t)(pktBuf[6] | (pktBuf[7] << 8));
-        target[3] = (int16_t)(pktBuf[8] | (pktBuf[9] << 8));
-        pktPos = 0;
-      }
+    // --- Input calibration measured by core 1 ---
+    if (input_cal_done) {
+      input_cal_done = false;
+      finish_input_calibration();
     }
 
     // --- Send input packets to host (16 bytes) ---
@@ -194,7 +1107,9 @@ static void __not_in_flash_func(usb_loop)() {
       inputs_ready = false;
 
       // Snapshot volatile values
-      uint8_t flags = input_flags;
+      uint32_t sample = input_sample;
+      uint8_t seq = (uint8_t)((sample / INPUT_REPORT_INTERVAL) & 0x0F);
+      uint8_t flags = input_flags | (seq << 4);
       int16_t cv0 = input_cv[0];
       int16_t cv1 = input_cv[1];
       int16_t audio0 = input_audio[0];
@@ -202,6 +1117,14 @@ static void __not_in_flash_func(usb_loop)() {
       int16_t knob0 = input_knobs[0];
       int16_t knob1 = input_knobs[1];
       int16_t knob2 = input_knobs[2];
+      uint8_t conn = input_connected;
+
+      if (input_units == INPUT_UNITS_MILLIVOLTS) {
+        cv0 = native_to_millivolts(cv0, ComputerCard::CV1, conn);
+        cv1 = native_to_millivolts(cv1, ComputerCard::CV2, conn);
+        audio0 = native_to_millivolts(audio0, ComputerCard::Audio1, conn);
+        audio1 = native_to_millivolts(audio1, ComputerCard::Audio2, conn);
+      }
 
       uint8_t outPkt[INPUT_PACKET_SIZE];
       outPkt[0] = SYNC_DEVICE_TO_HOST;
@@ -224,6 +1147,16 @@ static void __not_in_flash_func(usb_loop)() {
       for (int i = 0; i < INPUT_PACKET_SIZE; i++) {
         putchar_raw(outPkt[i]);
       }
+      if (!boot_first_report_us)
+        boot_first_report_us = time_us_32();
+
+      if (conn != jacks_sent)
+        send_jacks_event(conn);
+
+      if (++clockCounter >= CLOCK_EVENT_INTERVAL) {
+        clockCounter = 0;
+        send_clock_event(sample, seq);
+      }
     }
   }
 }
@@ -235,10 +1168,12 @@ static void __not_in_flash_func(usb_loop)() {
 int main() {
   // OSCBridge must exist before core 1 launch since core 1 immediately
   // calls RunWithBootSupport() on it. Note: ComputerCard's constructor
-  // also calls flash_get_unique_id() which disables XIP temporarily —
-  // a hazard if the other core were running flash-resident code.
+  // may also call flash_get_unique_id() and rewrite its calibration
+  // cache, which disable XIP temporarily — a hazard if the other core
+  // were running flash-resident code.
   static OSCBridge bridge;
   bridge_ptr = &bridge;
+  bridge.LoadInputCalibration();
 
   stdio_init_all();
 
@@ -0,0 +1,183 @@
+/*
+ * wc_shm.h
+ *
+ * Reader for the shared-memory segment wc_osc_bridge.py publishes with
+ * --shm: the latest input frame of one card plus a ring of recent frames,
+ * for local consumers (e.g. a VCV Rack module) that want the inputs
+ * without OSC encoding, UDP and OSC decoding in between.
+ *
+ * Header-only and POSIX (Linux, macOS). open() maps the segment; after
+ * that latest() and poll() are plain memory reads, no syscalls.
+ *
+ *   wcshm::Reader shm;
+ *   if (shm.open("/wc_bridge")) {
+ *     wcshm::Frame f;
+ *     if (shm.latest(f))
+ *       knob = f.values[wcshm::KNOB_MAIN];
+ *   }
+ *
+ * The layout is documented, and written, in wc_osc_bridge.py
+ * (SharedInputs); keep the two in step.
+ */
+
+#ifndef WC_SHM_H
+#define WC_SHM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wcshm {
+
+static constexpr uint32_t MAGIC = 0x4D534357; // "WCSM"
+static constexpr uint16_t VERSION = 1;
+
+// Frame::values indices, in the bridge's OSC address order
+enum Value {
+  AUDIO_IN1, // /ch/1
+  AUDIO_IN2, // /ch/2
+  CV_IN1,    // /ch/3
+  CV_IN2,    // /ch/4
+  KNOB_MAIN, // /knob/main
+  KNOB_X,    // /knob/x
+  KNOB_Y,    // /knob/y
+  SWITCH,    // /switch: 0 down, 1 middle, 2 up
+  PULSE_IN1, // /pulse/1: 0 or 1
+  PULSE_IN2, // /pulse/2
+  NUM_VALUES
+};
+
+struct Header {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t header_size; // offset of the latest frame
+  uint32_t frame_size;
+  uint32_t ring_frames;
+  uint32_t seq;         // odd while the latest frame is being written
+  uint32_t writer_pid;
+  uint64_t frames_written;
+  double created;       // host time (seconds since 1970) the bridge started
+  char prefix[24];      // card's OSC prefix, e.g. "/wc/left", or ""
+};
+
+struct Frame {
+  uint64_t index;     // frame number; frame n lives in ring slot n % ring_frames
+  double host_time;   // card's sample clock mapped to host time (seconds since 1970)
+  uint32_t sample;    // card's 48kHz sample clock, low 32 bits
+  uint32_t flags;     // raw report flags: bit 0-1 pulses, 2-3 switch, 4-7 sequence
+  float values[NUM_VALUES]; // volts (knobs 0-6V), see Value
+};
+
+static_assert(sizeof(Header) == 64, "Header layout must match wc_osc_bridge.py");
+static_assert(sizeof(Frame) == 64, "Frame layout must match wc_osc_bridge.py");
+
+class Reader {
+public:
+  Reader() = default;
+  Reader(const Reader &) = delete;
+  Reader &operator=(const Reader &) = delete;
+  ~Reader() { close(); }
+
+  // Map the segment, e.g. "/wc_bridge" (or "/wc_bridge_<card>" with
+  // several cards). False if the bridge isn't running with --shm, or the
+  // segment is from an incompatible version.
+  bool open(const char *name = "/wc_bridge") {
+    close();
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    void *p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= 2 * sizeof(Header))
+      p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+      return false;
+    base_ = (const uint8_t *)p;
+    size_ = st.st_size;
+
+    const Header *h = header();
+    if (h->magic != MAGIC || h->version != VERSION || h->frame_size != sizeof(Frame) ||
+        h->header_size + (h->ring_frames + 1) * (size_t)sizeof(Frame) > size_) {
+      close();
+      return false;
+    }
+    next_ = load(&h->frames_written);
+    return true;
+  }
+
+  void close() {
+    if (base_)
+      munmap((void *)base_, size_);
+    base_ = nullptr;
+    size_ = 0;
+  }
+
+  bool is_open() const { return base_ != nullptr; }
+  const Header *header() const { return (const Header *)base_; }
+
+  // Copy the most recent frame. False until the bridge has written one,
+  // or if it stays mid-write (the bridge's thread was preempted) for
+  // longer than a few retries; keep using the previous frame then.
+  bool latest(Frame &out) const {
+    const Header *h = header();
+    const Frame *src = (const Frame *)(base_ + h->header_size);
+    for (int tries = 0; tries < 100; tries++) {
+      uint32_t s1 = load(&h->seq);
+      if (s1 & 1)
+        continue;
+      memcpy(&out, src, sizeof(out));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (load(&h->seq) == s1)
+        return s1 != 0;
+    }
+    return false;
+  }
+
+  // Copy frames written since the last poll() (or open()) into out, oldest
+  // first, up to max. If the reader fell more than a ring behind, the
+  // frames it missed are skipped and counted in *lost.
+  size_t poll(Frame *out, size_t max, uint64_t *lost = nullptr) {
+    const Header *h = header();
+    const Frame *ring = (const Frame *)(base_ + h->header_size + sizeof(Frame));
+    uint64_t ring_frames = h->ring_frames;
+    uint64_t written = load(&h->frames_written);
+    size_t n = 0;
+    while (n < max && next_ < written) {
+      if (written - next_ > ring_frames - 1) {
+        // Overwritten already, or about to be: jump to the oldest safe frame
+        uint64_t skip = written - (ring_frames - 1) - next_;
+        if (lost)
+          *lost += skip;
+        next_ += skip;
+        continue;
+      }
+      memcpy(&out[n], &ring[next_ % ring_frames], sizeof(Frame));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // Frame next_ + ring_frames reuses the slot; it starts once
+      // frames_written reaches that, so the copy is good if it hasn't
+      written = load(&h->frames_written);
+      if (written - next_ >= ring_frames)
+        continue;
+      n++;
+      next_++;
+    }
+    return n;
+  }
+
+private:
+  template <typename T> static T load(const T *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+  const uint8_t *base_ = nullptr;
+  size_t size_ = 0;
+  uint64_t next_ = 0; // next ring frame poll() returns
+};
+
+} // namespace wcshm
+
+#endif // WC_SHM_H
@@ -0,0 +1,87 @@
+// Follows the bridge's shared-memory segment (wc_osc_bridge.py --shm) with
+// wc_shm.h, as a usage example and a latency check.
+//
+// Polls the ring and prints once a second: frames received, frames lost,
+// and how long after the card's sample clock (mapped to host time) each
+// frame became readable here — the part of the input path that --shm
+// replaces OSC/UDP for. It polls every 100µs, about as often as an audio
+// callback would; -s spins instead (only meaningful with a core to spare).
+// -v prints every frame instead of the summary.
+//
+//   ./build-host/wc_shm_tail [-v] [-s] [/wc_bridge]
+
+#include "wc_shm.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+static double host_now() {
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts); // same clock as Python's time.time()
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  bool verbose = false, spin = false;
+  const char *name = "/wc_bridge";
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0)
+      verbose = true;
+    else if (strcmp(argv[i], "-s") == 0)
+      spin = true;
+    else
+      name = argv[i];
+  }
+
+  wcshm::Reader shm;
+  if (!shm.open(name)) {
+    fprintf(stderr, "can't open %s: is wc_osc_bridge.py running with --shm?\n", name);
+    return 1;
+  }
+  const wcshm::Header *h = shm.header();
+  printf("%s: bridge pid %u, %s, ring of %u frames\n", name, h->writer_pid,
+         h->prefix[0] ? h->prefix : "(no prefix)", h->ring_frames);
+
+  wcshm::Frame frames[256];
+  std::vector<double> latency;
+  uint64_t lost = 0, received = 0;
+  double next_report = host_now() + 1.0;
+  const timespec idle = {0, 100000};
+
+  for (;;) {
+    size_t n = shm.poll(frames, 256, &lost);
+    double now = host_now();
+    for (size_t i = 0; i < n; i++) {
+      const wcshm::Frame &f = frames[i];
+      latency.push_back((now - f.host_time) * 1e3);
+      if (verbose)
+        printf("%10llu %10u  %+7.3f %+7.3f %+7.3f %+7.3f  %5.3f %5.3f %5.3f  %.0f %.0f%.0f\n",
+               (unsigned long long)f.index, f.sample, f.values[wcshm::AUDIO_IN1],
+               f.values[wcshm::AUDIO_IN2], f.values[wcshm::CV_IN1], f.values[wcshm::CV_IN2],
+               f.values[wcshm::KNOB_MAIN], f.values[wcshm::KNOB_X], f.values[wcshm::KNOB_Y],
+               f.values[wcshm::SWITCH], f.values[wcshm::PULSE_IN1], f.values[wcshm::PULSE_IN2]);
+    }
+    received += n;
+
+    if (!verbose && now >= next_report) {
+      if (latency.empty()) {
+        printf("no frames\n");
+      } else {
+        std::sort(latency.begin(), latency.end());
+        auto pct = [&](double p) { return latency[(size_t)(p / 100 * (latency.size() - 1))]; };
+        printf("%6llu frames/s  lost %llu  latency p50 %.2fms p99 %.2fms max %.2fms\n",
+               (unsigned long long)received, (unsigned long long)lost, pct(50), pct(99),
+               latency.back());
+      }
+      fflush(stdout);
+      latency.clear();
+      received = 0;
+      next_report += 1.0;
+    }
+    if (!n && !spin)
+      nanosleep(&idle, nullptr);
+  }
+}
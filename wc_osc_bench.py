@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+# /// script
+# requires-python = ">=3.10"
+# dependencies = [
+#     "python-osc",
+# ]
+# ///
+"""
+wc_osc_bench.py
+
+End-to-end latency and throughput benchmark for the OSC bridge.
+
+Sends /ch/1 to the bridge at a controlled rate and times how long each
+value takes to come back as /ch/1 from the bridge. Needs Audio Out 1 fed
+back into Audio In 1 — a patch cable on a real card, or the simulator
+started with --loopback:
+
+  ./build-host/wc_osc_bridge_sim --loopback --link /tmp/wc-sim
+  uv run wc_osc_bridge.py --port /tmp/wc-sim
+  uv run wc_osc_bench.py --sweep 100,200,500,1000,2000,5000,10000
+
+Each value sent is one of --levels distinct voltages, so the value that
+comes back identifies the message that produced it. A message that is
+overwritten before the card reports it (the card reports at 1kHz) counts
+as coalesced rather than lost, and latency is measured from the most
+recent send of the returned level.
+
+Percentiles are printed per rate. With --sweep the first rate whose p90
+latency exceeds twice the lowest rate's p90 (plus 1ms) is flagged as the
+saturation point: somewhere between OutputBridge.osc_handler, the serial
+link and usb_loop is queueing. --json saves the numbers so performance
+changes can be compared run to run.
+"""
+
+import argparse
+import json
+import platform
+import socket
+import threading
+import time
+from collections import deque
+
+from pythonosc import osc_message_builder, osc_packet
+
+
+def percentile(sorted_values, p):
+    """Nearest-rank percentile of an already sorted list."""
+    if not sorted_values:
+        return float("nan")
+    k = max(0, min(len(sorted_values) - 1, round(p / 100 * (len(sorted_values) - 1))))
+    return sorted_values[k]
+
+
+class LatencyRun:
+    """Send /ch/1 at a fixed rate and match returned values to sends."""
+
+    def __init__(self, args, rate):
+        self.args = args
+        self.rate = rate
+        span = args.max_volts - args.min_volts
+        self.levels = [args.min_volts + span * i / (args.levels - 1) for i in range(args.levels)]
+        self.tolerance = span / (args.levels - 1) * 0.4
+        self.dgrams = []
+        for v in self.levels:
+            b = osc_message_builder.OscMessageBuilder(args.address)
+            b.add_arg(float(v), "f")
+            self.dgrams.append(b.build().dgram)
+
+        # Per-level queue of pending send times (perf_counter seconds)
+        self.pending = [deque() for _ in self.levels]
+        self.lock = threading.Lock()
+        self.latencies = []
+        self.sent = 0
+        self.matched = 0
+        self.unmatched = 0
+        self.measuring = False
+
+    def level_order(self):
+        # Stride through the levels so consecutive values are far apart
+        stride = self.args.levels // 2 + 1
+        while any(self.args.levels % d == 0 and stride % d == 0 for d in range(2, stride + 1)):
+            stride += 1
+        i = 0
+        while True:
+            yield i
+            i = (i + stride) % self.args.levels
+
+    def sender(self, sock, stop_at):
+        target = (self.args.host, self.args.port)
+        period = 1.0 / self.rate
+        order = self.level_order()
+        next_t = time.perf_counter()
+        while True:
+            now = time.perf_counter()
+            if now >= stop_at:
+                break
+            if now < next_t:
+                # Sleep short of the deadline; sleep(0) still releases the GIL
+                # so the receiver's timestamps aren't held up by this loop
+                gap = next_t - now
+                time.sleep(gap - 0.0001 if gap > 0.0002 else 0)
+                continue
+            i = next(order)
+            with self.lock:
+                sock.sendto(self.dgrams[i], target)
+                if self.measuring:
+                    self.pending[i].append(time.perf_counter())
+                    self.sent += 1
+            next_t += period
+            # Don't try to catch up a long stall in one burst
+            if time.perf_counter() - next_t > 0.05:
+                next_t = time.perf_counter()
+
+    def on_value(self, value, t_recv):
+        i = min(range(len(self.levels)), key=lambda j: abs(self.levels[j] - value))
+        if abs(self.levels[i] - value) > self.tolerance:
+            return
+        with self.lock:
+            if not self.measuring:
+                return
+            q = self.pending[i]
+            if not q:
+                self.unmatched += 1
+                return
+            # Most recent send of this level wins; older ones were superseded
+            t_sent = q.pop()
+            q.clear()
+            self.latencies.append(t_recv - t_sent)
+            self.matched += 1
+
+    def receiver(self, sock, stop_event):
+        while not stop_event.is_set():
+            try:
+                data, _ = sock.recvfrom(65536)
+            except socket.timeout:
+                continue
+            t_recv = time.perf_counter()
+            try:
+                packet = osc_packet.OscPacket(data)
+            except Exception:
+                continue
+            for timed in packet.messages:
+                msg = timed.message
+                if msg.address == self.args.address and msg.params:
+                    self.on_value(float(msg.params[0]), t_recv)
+
+    def run(self, recv_sock):
+        send_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        stop_event = threading.Event()
+        rx = threading.Thread(target=self.receiver, args=(recv_sock, stop_event), daemon=True)
+        rx.start()
+
+        start = time.perf_counter()
+        warmup_end = start + self.args.warmup
+        stop_at = warmup_end + self.args.duration
+        tx = threading.Thread(target=self.sender, args=(send_sock, stop_at), daemon=True)
+        tx.start()
+
+        time.sleep(self.args.warmup)
+        with self.lock:
+            self.measuring = True
+        tx.join()
+        # Let the last values arrive
+        time.sleep(self.args.settle)
+        with self.lock:
+            self.measuring = False
+        stop_event.set()
+        rx.join()
+        send_sock.close()
+        return self.result()
+
+    def result(self):
+        lat = sorted(x * 1000 for x in self.latencies)
+        duration = self.args.duration
+        expected = min(1.0, self.args.report_rate / self.rate)
+        return {
+            "rate": self.rate,
+            "sent_per_s": self.sent / duration,
+            "matched_per_s": self.matched / duration,
+            "delivered": self.matched / self.sent if self.sent else 0.0,
+            "expected_delivered": expected,
+            "unmatched": self.unmatched,
+            "p50_ms": percentile(lat, 50),
+            "p90_ms": percentile(lat, 90),
+            "p99_ms": percentile(lat, 99),
+            "max_ms": lat[-1] if lat else float("nan"),
+            "samples": len(lat),
+        }
+
+
+def print_header():
+    print(f"{'rate':>7} {'sent/s':>8} {'back/s':>8} {'deliv':>6} {'expect':>6}"
+          f" {'p50':>7} {'p90':>7} {'p99':>7} {'max':>7}  (ms)")
+
+
+def print_row(r, flag=""):
+    print(f"{r['rate']:>7.0f} {r['sent_per_s']:>8.0f} {r['matched_per_s']:>8.0f}"
+          f" {r['delivered'] * 100:>5.1f}% {r['expected_delivered'] * 100:>5.1f}%"
+          f" {r['p50_ms']:>7.2f} {r['p90_ms']:>7.2f} {r['p99_ms']:>7.2f} {r['max_ms']:>7.2f}{flag}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Latency/throughput benchmark for the WC OSC bridge")
+    parser.add_argument("--host", default="127.0.0.1", help="Bridge host (default: 127.0.0.1)")
+    parser.add_argument("--port", type=int, default=7000, help="Bridge OSC receive port (default: 7000)")
+    parser.add_argument("--listen-port", type=int, default=7001,
+                        help="Port the bridge sends OSC to (default: 7001)")
+    parser.add_argument("--address", default="/ch/1", help="OSC address to send and match (default: /ch/1)")
+    parser.add_argument("--rate", type=float, default=100.0, help="Messages per second (default: 100)")
+    parser.add_argument("--sweep", help="Comma-separated list of rates to run in turn")
+    parser.add_argument("--duration", type=float, default=10.0, help="Seconds measured per rate (default: 10)")
+    parser.add_argument("--warmup", type=float, default=0.5, help="Seconds sent before measuring (default: 0.5)")
+    parser.add_argument("--settle", type=float, default=0.2, help="Seconds to wait for stragglers (default: 0.2)")
+    parser.add_argument("--levels", type=int, default=64, help="Distinct values cycled through (default: 64)")
+    parser.add_argument("--min-volts", type=float, default=-4.8)
+    parser.add_argument("--max-volts", type=float, default=4.8)
+    parser.add_argument("--report-rate", type=float, default=1000.0,
+                        help="Card input report rate, for expected delivery (default: 1000)")
+    parser.add_argument("--json", help="Append results to this JSON file")
+    args = parser.parse_args()
+
+    rates = [float(r) for r in args.sweep.split(",")] if args.sweep else [args.rate]
+
+    recv_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    recv_sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+    recv_sock.bind(("0.0.0.0", args.listen_port))
+    recv_sock.settimeout(0.05)
+
+    print(f"Sending {args.address} → {args.host}:{args.port}, listening on :{args.listen_port}")
+    print(f"{args.duration:.0f}s per rate, {args.levels} levels {args.min_volts:+.1f}..{args.max_volts:+.1f}V\n")
+    print_header()
+
+    results = []
+    baseline_p90 = None
+    saturation = None
+    for rate in rates:
+        r = LatencyRun(args, rate).run(recv_sock)
+        results.append(r)
+        flag = ""
+        if r["samples"] == 0:
+            flag = "  <- nothing came back (is Audio Out 1 patched to Audio In 1?)"
+        else:
+            if baseline_p90 is None:
+                baseline_p90 = r["p90_ms"]
+            elif saturation is None and r["p90_ms"] > 2 * baseline_p90 + 1.0:
+                saturation = rate
+                flag = "  <- saturated"
+        print_row(r, flag)
+
+    if len(rates) > 1:
+        print()
+        if saturation:
+            print(f"Saturation at ~{saturation:.0f} msg/s (p90 more than doubled)")
+        else:
+            print("No saturation within the swept rates")
+
+    if args.json:
+        record = {
+            "time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            "host": platform.node(),
+            "args": vars(args),
+            "results": results,
+            "saturation_rate": saturation,
+        }
+        try:
+            with open(args.json) as f:
+                history = json.load(f)
+        except (FileNotFoundError, json.JSONDecodeError):
+            history = []
+        history.append(record)
+        with open(args.json, "w") as f:
+            json.dump(history, f, indent=2)
+        print(f"Results appended to {args.json}")
+
+
+if __name__ == "__main__":
+    main()
@@ -22,8 +22,10 @@ Two directions:
   WC → OSC:  WC inputs → binary USB → this script → OSC → OSC server
 
 Binary protocol:
-  Host→Device (10 bytes): 0xC0, flags, int16[4] (little-endian, -2048..2047)
+  Host→Device (10 bytes): 0xC0, flags, 4 x signed 14-bit as two 7-bit bytes (-2048..2047)
+  Host→Device (10 bytes): 0xC2, command, 8 payload bytes (7 bits each)
   Device→Host (16 bytes): 0xC1, flags, int16[2] CV, int16[2] audio, int16[3] knobs
+  Device→Host (16 bytes): 0xC3, event, 14 payload bytes
 
 Channel → Workshop Computer output mapping:
   /ch/1  →  Audio Out 1  (SPI DAC, 12-bit, 48kHz — best for LFO/continuous CV)
@@ -32,6 +34,10 @@ Channel → Workshop Computer output mapping:
   /ch/4  →  CV Out 2     (PWM, 11-bit)
   /pulse/1 → Pulse Out 1  (GPIO, digital — gates/triggers, threshold > 0V)
   /pulse/2 → Pulse Out 2  (GPIO, digital)
+  /pulse/N/trigger [ms] → a pulse of that width on Pulse Out N (default 10ms),
+                          timed on the card to the sample
+  /pulse/N/clock source [× ÷ swing% chance% ms] → Pulse Out N derived on the
+                          card from Pulse In <source> (0 off), see OutputBridge
 
 Workshop Computer input → OSC mapping:
   Audio In 1  →  /ch/1
@@ -45,27 +51,99 @@ Workshop Computer input → OSC mapping:
   Pulse In 1  →  /pulse/1    (1.0 or 0.0)
   Pulse In 2  →  /pulse/2    (1.0 or 0.0)
 
+Each device report (1kHz) goes out as one OSC bundle holding the values
+that changed, timetagged with the card's sample clock mapped to host time
+(--osc-bundles device). "immediate" keeps the bundles but without a time,
+"off" sends one message per value as before.
+
+Bundles sent to the bridge with a timetag in the future are not applied
+on arrival: /ch/* and /pulse/* messages in them are converted to the
+card's sample clock and queued on the card, which applies them on the
+exact sample. Senders should timetag some tens of ms ahead to absorb
+network jitter; anything arriving late is applied immediately.
+
+Inputs go to --osc-send-ip:--osc-send-port and to any client that sends
+/bridge/subscribe [port] [pattern] [rate] [threshold] to the bridge, each
+with its own address pattern, rate limit and change threshold;
+/bridge/unsubscribe [port] stops it. A subscription lapses after a minute
+unless sent again, at most 16 are kept, and only private addresses may
+subscribe unless --subscribe-allow says otherwise.
+
+Which values are sent is set per address by an output policy: deadband,
+hysteresis, max rate and keepalive, with defaults per signal type
+(DEFAULT_POLICIES) that --output-policy FILE (JSON) can override.
+
+--shm also publishes every report to a POSIX shared-memory segment
+(latest frame plus a ring of recent ones) for local readers; see
+shm/wc_shm.h.
+
+--record FILE saves the raw device stream with receive times; --replay
+FILE plays it back through the bridge instead of a card, at
+--replay-speed times real time, to reproduce problems offline.
+
+With several cards (--all-cards, or --port given more than once) each
+card's addresses in both directions move under /wc/<card id>/, e.g.
+/wc/187c3e15287a8f65/ch/1; --card-name ID=NAME picks a shorter name.
+
 All values are ComputerCard native range: -2048 to +2047
 (approx -6V to +6V, 12V span). Voltage conversion is done here in Python.
 
+CV Out modes (--cv-mode) for /ch/3 and /ch/4:
+  native     11-bit native values, uncalibrated (default)
+  mv         millivolts, mapped through the card's calibration
+  precise    calibrated 19-bit values (~23µV per step) — best for V/oct
+
+Input units (--input-units) for /ch/1-4:
+  native     native values converted here assuming a perfect 12V span (default)
+  mv         calibrated millivolts reported by the card (see --calibrate-inputs)
+
+Knob filter (--knob-filter) for /knob/* and /switch:
+  smooth     the card's fixed ~15Hz filter: ~25ms to follow a knob twist (default)
+  adaptive   follows a turning knob within ~1ms, holds a still one steady
+
+CV In filter (--cv-in-filter) for /ch/3-4:
+  smooth     the card's ~240Hz filter, read once per report — fine for V/oct (default)
+  raw        filter off on the card (24kHz per input), each report carries the
+             mean since the last one: -3dB at ~440Hz, far less aliasing
+
+Jack detection (--norm-probe) for /jack/ch/1-4, /jack/pulse/1-2 (1 patched, 0 not):
+  always     the card probes continuously; unpatched inputs read 0 (default)
+  scheduled  probes ~11ms once a second, a change needs two probes to agree
+             (shows after 1-2 s)
+  off        no probing, jacks keep the state they had — for fixed patches
+
 Usage:
   uv run wc_osc_bridge.py --port /dev/tty.usbmodem*
+  uv run wc_osc_bridge.py --all-cards --card-name 187c3e15287a8f65=left
+  uv run wc_osc_bridge.py --record gig.wcs     # later: --replay gig.wcs
+  uv run wc_osc_bridge.py --calibrate-inputs all   # patch CV Out 1/2 → inputs first
 
 OSC setup:
   - Send OSC messages to port 7000 (this script receives them)
   - Listen on port 7001 for WC input values (this script sends them)
   - Output channels: /ch/1 .. /ch/4, /pulse/1 .. /pulse/2
-  - Input channels: /ch/1 .. /ch/4, /knob/main, /knob/x, /knob/y, /switch, /pulse/1, /pulse/2
+  - Input channels: /ch/1 .. /ch/4, /knob/main, /knob/x, /knob/y, /switch, /pulse/1, /pulse/2,
+    /jack/ch/1 .. /jack/pulse/2 when jacks are plugged or unplugged,
+    /pulse/N/bpm and /pulse/N/period for a clock on Pulse In N
 """
 
 import argparse
+import asyncio
+import heapq
+import ipaddress
+import json
+import mmap
+import os
+import re
 import socket
 import struct
 import threading
 import time
 import sys
 import serial
-from pythonosc import udp_client, dispatcher, osc_server
+from serial.tools import list_ports
+from multiprocessing import shared_memory
+from pythonosc import dispatcher, osc_packet, osc_server
 from zeroconf import ServiceInfo, Zeroconf
 
 
@@ -75,8 +153,77 @@ from zeroconf import ServiceInfo, Zeroconf
 
 SYNC_HOST_TO_DEVICE = 0xC0
 SYNC_DEVICE_TO_HOST = 0xC1
-OUTPUT_PACKET_SIZE = 10  # host → device
-INPUT_PACKET_SIZE = 16   # device → host
+SYNC_HOST_COMMAND = 0xC2
+SYNC_DEVICE_EVENT = 0xC3
+
+# Wire format version the card reports in EVT_CARD_INFO (0 from firmware
+# older than the check); the bridge only runs a card with the same one
+PROTOCOL_VERSION = 2
+OUTPUT_PACKET_SIZE = 10  # host → device (data and command)
+INPUT_PACKET_SIZE = 16   # device → host (inputs and events)
+
+# Command ids (byte 1 of a 0xC2 packet)
+CMD_SET_CV_MODE = 0x01     # d0: CV Out 1 mode, d1: CV Out 2 mode
+CMD_SET_CV_PRECISE = 0x02  # d0-2: CV Out 1, d3-5: CV Out 2 (signed 21-bit)
+CMD_CALIBRATE_INPUTS = 0x03  # d0: input mask
+CMD_SET_INPUT_UNITS = 0x04   # d0: 0 native, 1 calibrated millivolts
+CMD_RESET_INPUT_CAL = 0x05   # d0: input mask
+CMD_SCHEDULE = 0x06          # d0-3: sample clock (low 28 bits), d4: channel, d5-7: value
+CMD_GET_CARD_INFO = 0x07     # replies with EVT_CARD_INFO
+CMD_SET_KNOB_FILTER = 0x08   # d0: 0 smooth, 1 adaptive
+CMD_SET_CV_IN_FILTER = 0x09  # d0: 0 smooth, 1 raw
+CMD_SET_NORM_PROBE = 0x0A    # d0: 0 off, 1 always, 2 scheduled; replies with EVT_JACKS
+CMD_SET_BOOT_MODE = 0x0B     # d0: 0 animated, 1 fast; stored in flash
+CMD_GET_BOOT_TIMES = 0x0C    # replies with EVT_BOOT_TIMES
+CMD_TRIGGER = 0x0D           # d0: pulse out (0/1), d1-3: width in µs (21-bit)
+CMD_SET_CLOCK = 0x0E         # d0: pulse out, d1: source, d2: ×, d3: ÷, d4: swing %, d5: chance %,
+                             # d6-7: width in 100µs
+CMD_CLEAR_SCHEDULE = 0x0F    # drops scheduled events not yet applied
+
+# CMD_SET_CLOCK sources
+CLOCK_SOURCE_OFF = 0
+
+# Event ids (byte 1 of a 0xC3 packet)
+EVT_INPUT_CAL = 0x01  # u8 input, u8 status, i32 offset_q4, i32 gain_q16
+EVT_CLOCK = 0x02      # u32 sample clock of the last report, u8 sequence
+EVT_CARD_INFO = 0x03  # u64 UniqueCardID, u8 protocol version
+EVT_JACKS = 0x04      # u8 connected mask (audio 1-2, CV 1-2, pulse 1-2), u8 changed mask
+EVT_BOOT_TIMES = 0x05 # u8 calibration source, u16 µs x5, u16 ms to first report
+EVT_TEMPO = 0x06      # u8 pulse in, u32 period (samples × 256, 0 stopped), u32 sample clock of last edge
+EVT_SCHEDULE_FULL = 0x07  # u8 channel of the dropped event, u32 events dropped since boot
+
+# Device sample clock: 0xC1 reports are INPUT_REPORT_INTERVAL samples apart
+# and carry a 4-bit sequence number in flags bits 4-7
+SAMPLE_RATE = 48000
+INPUT_REPORT_INTERVAL = 48
+
+# CV Out modes
+CV_MODES = {"native": 0, "mv": 1, "precise": 2}
+
+# Input units
+INPUT_UNITS = {"native": 0, "mv": 1}
+
+# Knob filters
+KNOB_FILTERS = {"smooth": 0, "adaptive": 1}
+
+# CV In filters
+CV_IN_FILTERS = {"smooth": 0, "raw": 1}
+
+# Normalisation probe (jack detection) schedules
+NORM_PROBES = {"off": 0, "always": 1, "scheduled": 2}
+
+# Boot modes, stored on the card
+BOOT_MODES = {"animated": 0, "fast": 1}
+
+# EVT_BOOT_TIMES: where the CV Out calibration came from, and the phases
+# of ComputerCard's constructor, in order
+CAL_SOURCES = {0: "defaults (no EEPROM calibration)", 1: "EEPROM", 2: "flash cache"}
+BOOT_PHASES = ["reset → ComputerCard", "hardware init", "CV Out calibration", "card ID", "cache write"]
+
+# Calibration input masks (bit per ComputerCard::Input: Audio1, Audio2, CV1, CV2)
+CAL_INPUT_NAMES = ["Audio In 1", "Audio In 2", "CV In 1", "CV In 2"]
+CAL_INPUT_MASKS = {"audio": 0x03, "cv": 0x0C, "all": 0x0F}
+CAL_STATUS = {0: "ok", 1: "out of range — is CV Out patched in?", 2: "reset to nominal"}
 
 # ComputerCard native range: -2048 to 2047
 # Maps to approximately -6V to +6V (12V range)
@@ -96,6 +243,528 @@ def native_to_volts(native: int) -> float:
     return native * VOLTAGE_RANGE / (NATIVE_MAX - NATIVE_MIN + 1)
 
 
+# Calibrated 19-bit CV range: -262144 to 262143 (approx -6V to +6V)
+PRECISE_MIN = -262144
+PRECISE_MAX = 262143
+
+
+def volts_to_precise(volts: float) -> int:
+    """Convert voltage (-6V to +6V) to calibrated 19-bit CV value."""
+    precise = round(volts / VOLTAGE_RANGE * (PRECISE_MAX - PRECISE_MIN + 1))
+    return max(PRECISE_MIN, min(PRECISE_MAX, precise))
+
+
+def pack_s21(value: int) -> bytes:
+    """Pack a signed 21-bit value as three 7-bit bytes, LSB first."""
+    v = value & 0x1FFFFF
+    return bytes((v & 0x7F, (v >> 7) & 0x7F, (v >> 14) & 0x7F))
+
+
+def data_packet(flags: int, values) -> bytes:
+    """
+    Build a 10-byte 0xC0 data packet: flags and four signed 14-bit values,
+    each as two 7-bit bytes, LSB first. Like command payloads, no byte
+    after the sync can be mistaken for a sync byte.
+    """
+    out = bytearray((SYNC_HOST_TO_DEVICE, flags & 0x7F))
+    for v in values:
+        v &= 0x3FFF
+        out += bytes((v & 0x7F, v >> 7))
+    return bytes(out)
+
+
+def pack_u21(value: int) -> bytes:
+    """Pack the low 21 bits of value as three 7-bit bytes, LSB first."""
+    v = value & 0x1FFFFF
+    return bytes((v & 0x7F, (v >> 7) & 0x7F, (v >> 14) & 0x7F))
+
+
+def pack_u28(value: int) -> bytes:
+    """Pack the low 28 bits of value as four 7-bit bytes, LSB first."""
+    v = value & 0x0FFFFFFF
+    return bytes((v & 0x7F, (v >> 7) & 0x7F, (v >> 14) & 0x7F, (v >> 21) & 0x7F))
+
+
+def command_packet(cmd: int, payload: bytes = b"") -> bytes:
+    """Build a 10-byte 0xC2 command packet. Payload bytes must be 7-bit."""
+    payload = payload.ljust(OUTPUT_PACKET_SIZE - 2, b"\x00")
+    assert all(b < 0x80 for b in payload)
+    return bytes((SYNC_HOST_COMMAND, cmd)) + payload
+
+
+def release_packets() -> bytes:
+    """
+    Commands that hand the pulse outs back from anything a previous
+    session left running on the card: both clock processors off and every
+    scheduled event not yet applied dropped. Sent on connect and on exit.
+    """
+    off = [command_packet(CMD_SET_CLOCK, bytes((out, CLOCK_SOURCE_OFF, 1, 1, 50, 100, 100, 0)))
+           for out in (0, 1)]
+    return command_packet(CMD_CLEAR_SCHEDULE) + b"".join(off)
+
+
+# ---------------------------------------------------------------------------
+# Device clock
+# ---------------------------------------------------------------------------
+
+class DeviceClock:
+    """
+    Tracks the card's 48kHz sample clock and its offset from host time.
+
+    Reports are counted by sequence number and re-anchored by each EVT_CLOCK,
+    so every report gets a device time. The offset (host - device seconds)
+    is the lower envelope of report arrival times — USB only ever adds delay,
+    so the earliest arrival is the best estimate — leaking upward at DRIFT
+    so the two crystals drifting apart can't stall it.
+    """
+    DRIFT = 200e-6  # seconds per second
+
+    def __init__(self):
+        self.sample = None  # unwrapped sample clock of the last report
+        self.seq = None
+        self.offset = None
+        self.offset_at = 0.0
+        self.lock = threading.Lock()
+
+    def on_report(self, seq, arrival):
+        """Count a 0xC1 report arriving at host time arrival; returns its device time or None."""
+        last, self.seq = self.seq, seq
+        if self.sample is None or last is None:
+            return None
+        self.sample += (((seq - last) & 0x0F) or 16) * INPUT_REPORT_INTERVAL
+        device = self.sample / SAMPLE_RATE
+        self.update_offset(device, arrival)
+        return device
+
+    def on_clock_event(self, sample, seq):
+        """Anchor to an EVT_CLOCK, which describes the report just before it."""
+        if seq != self.seq:
+            return  # a report went missing in between; wait for the next event
+        if self.sample is None:
+            self.sample = sample
+            return
+        diff = (sample - self.sample + 2**31) % 2**32 - 2**31
+        self.sample += diff
+        if abs(diff) > SAMPLE_RATE:
+            # The card restarted, or we lost the stream for a while
+            with self.lock:
+                self.offset = None
+
+    def update_offset(self, device, arrival):
+        d = arrival - device
+        with self.lock:
+            if self.offset is None:
+                self.offset = d
+            else:
+                self.offset = min(d, self.offset + self.DRIFT * (arrival - self.offset_at))
+            self.offset_at = arrival
+
+    def device_to_host(self, device):
+        """Device seconds → host time.time() seconds, or None until synced."""
+        with self.lock:
+            return None if self.offset is None else device + self.offset
+
+    def host_to_device(self, host):
+        """Host time.time() seconds → device seconds, or None until synced."""
+        with self.lock:
+            return None if self.offset is None else host - self.offset
+
+
+# ---------------------------------------------------------------------------
+# OSC output encoding
+# ---------------------------------------------------------------------------
+
+NTP_EPOCH_OFFSET = 2208988800  # 1900-01-01 → 1970-01-01
+TIMETAG_IMMEDIATELY = struct.pack('>II', 0, 1)
+
+
+def osc_string(s: str) -> bytes:
+    """OSC string: NUL-terminated, padded to a multiple of 4 bytes."""
+    b = s.encode() + b"\0"
+    return b + b"\0" * (-len(b) % 4)
+
+
+def ntp_timetag(t: float) -> bytes:
+    """OSC timetag for a time.time() value."""
+    secs = int(t)
+    frac = min(int((t - secs) * 2**32), 2**32 - 1)
+    return struct.pack('>II', secs + NTP_EPOCH_OFFSET, frac)
+
+
+def osc_pattern(pattern):
+    """
+    Compile an OSC address pattern to a regex: * and ? match within one
+    path segment, [abc] / [!abc] a character, {ch,knob} one of several
+    alternatives. An empty pattern matches every address.
+    """
+    return re.compile(osc_pattern_regex(pattern) if pattern else ".*")
+
+
+def osc_pattern_regex(pattern):
+    out = []
+    i = 0
+    while i < len(pattern):
+        c = pattern[i]
+        close = {"[": "]", "{": "}"}.get(c)
+        j = pattern.find(close, i) if close else -1
+        if c == "*":
+            out.append("[^/]*")
+        elif c == "?":
+            out.append("[^/]")
+        elif c == "[" and j > i:
+            body = pattern[i + 1:j]
+            if body.startswith("!"):
+                body = "^" + body[1:]
+            out.append("[" + body.replace("\\", "\\\\") + "]")
+            i = j
+        elif c == "{" and j > i:
+            alternatives = pattern[i + 1:j].split(",")
+            out.append("(?:" + "|".join(osc_pattern_regex(a) for a in alternatives) + ")")
+            i = j
+        else:
+            out.append(re.escape(c))
+        i += 1
+    return "".join(out)
+
+
+class SendPolicy:
+    """
+    When an input value is worth sending to a client:
+      deadband    smallest change (volts) from the last value sent
+      hysteresis  extra change needed to reverse direction, so a value
+                  jittering between two steps stays quiet
+      max_rate    most messages per second (0: no limit); a change held
+                  back is sent on a later report once the interval is up
+      keepalive   resend an unchanged value after this many seconds (0: never)
+    """
+    FIELDS = ("deadband", "hysteresis", "max_rate", "keepalive")
+
+    def __init__(self, deadband=0.005, hysteresis=0.0, max_rate=0.0, keepalive=0.0):
+        self.deadband = deadband
+        self.hysteresis = hysteresis
+        self.min_interval = 1.0 / max_rate if max_rate > 0 else 0.0
+        self.keepalive = keepalive
+
+    def describe(self):
+        rate = f"{1 / self.min_interval:g}/s" if self.min_interval else "unlimited"
+        return (f"deadband {self.deadband:g}V hysteresis {self.hysteresis:g}V rate {rate}"
+                f" keepalive {self.keepalive:g}s")
+
+
+# Per-address defaults, by signal type. Addresses are matched with and
+# without their /wc/<card>/ prefix; later entries override earlier ones
+# field by field, and --output-policy entries come after these.
+DEFAULT_POLICIES = [
+    # Audio ins are noisier (3mV per code): a wider deadband, but no rate
+    # limit so fast signals still come through
+    ("/ch/{1,2}", dict(deadband=0.01, hysteresis=0.01, keepalive=1.0)),
+    # CV ins: fine deadband, with hysteresis for the last-bits flicker
+    ("/ch/{3,4}", dict(deadband=0.005, hysteresis=0.01, keepalive=1.0)),
+    # Knobs jitter by a few ADC codes (1.5mV each) and nobody turns a
+    # knob faster than 100 updates a second
+    ("/knob/*", dict(deadband=0.005, hysteresis=0.01, max_rate=100, keepalive=1.0)),
+    # Discrete: every change, never rate limited, so no edge is lost
+    ("/{switch,pulse/*}", dict(deadband=0.0, keepalive=1.0)),
+    # Jack events: sent when a jack changes, so no keepalive
+    ("/jack/*/*", dict(deadband=0.0)),
+    # Tempo: sent when the card's estimate moves, likewise
+    ("/pulse/*/{bpm,period}", dict(deadband=0.0)),
+]
+
+
+class PolicyTable:
+    """Ordered (address pattern, policy fields) entries, resolved per address."""
+
+    def __init__(self, entries=(), overrides=None):
+        self.entries = [(p, osc_pattern(p), f) for p, f in entries]
+        self.overrides = {k: v for k, v in (overrides or {}).items() if v is not None}
+
+    def with_overrides(self, **overrides):
+        """Copy of this table with fields forced for every address (None: keep)."""
+        table = PolicyTable()
+        table.entries = self.entries
+        table.overrides = dict(self.overrides)
+        table.overrides.update((k, v) for k, v in overrides.items() if v is not None)
+        return table
+
+    def policy(self, address):
+        relative = re.sub(r"^/wc/[^/]+", "", address)
+        fields = {}
+        for _, regex, f in self.entries:
+            if regex.fullmatch(address) or regex.fullmatch(relative):
+                fields.update(f)
+        fields.update(self.overrides)
+        return SendPolicy(**fields)
+
+
+def threshold_overrides(threshold):
+    """
+    Policy overrides for a --threshold in volts (None: keep the policy).
+    A negative threshold sends every value of every report: no deadband,
+    hysteresis or rate limit, so no keepalive is needed either.
+    """
+    if threshold is None:
+        return {}
+    if threshold < 0:
+        return dict(deadband=-1.0, hysteresis=0.0, max_rate=0.0, keepalive=0.0)
+    return dict(deadband=threshold)
+
+
+def load_policies(path):
+    """
+    Read --output-policy: a JSON object mapping OSC address patterns to
+    policy fields, e.g. {"/knob/*": {"deadband": 0.02, "max_rate": 50}}.
+    """
+    with open(path) as f:
+        config = json.load(f)
+    if not isinstance(config, dict):
+        raise ValueError("expected an object of address pattern → policy")
+    entries = []
+    for pattern, fields in config.items():
+        if not isinstance(fields, dict):
+            raise ValueError(f"{pattern}: expected an object of policy fields")
+        unknown = set(fields) - set(SendPolicy.FIELDS)
+        if unknown:
+            raise ValueError(f"{pattern}: unknown field(s) {', '.join(sorted(unknown))}"
+                             f" (expected {', '.join(SendPolicy.FIELDS)})")
+        entries.append((pattern, {k: float(v) for k, v in fields.items()}))
+    return entries
+
+
+class Subscriber:
+    """
+    One OSC client receiving WC inputs: the addresses it wants and the
+    SendPolicy for each, from its PolicyTable.
+    """
+
+    def __init__(self, target, pattern="", policies=None, expires=None):
+        self.target = target
+        self.expires = expires  # host time it lapses unless renewed; None never
+        self.send_failed = False  # reported a send error already
+        self.pattern = pattern
+        self.regex = osc_pattern(pattern)
+        self.policies = policies or PolicyTable(DEFAULT_POLICIES)
+        self.wanted = {}  # address tuple → [(index, SendPolicy)] matching the pattern
+        self.state = {}   # address → [last sent value, host time sent, direction]
+
+    def describe(self):
+        forced = ", ".join(f"{k} {v:g}" for k, v in self.policies.overrides.items())
+        return (f"{self.target[0]}:{self.target[1]} {self.pattern or '(all)'}"
+                + (f" ({forced})" if forced else ""))
+
+    def select(self, addresses, values, now):
+        """Indices of the values this client should be sent now."""
+        wanted = self.wanted.get(addresses)
+        if wanted is None:
+            wanted = self.wanted[addresses] = [
+                (i, self.policies.policy(a)) for i, a in enumerate(addresses)
+                if self.regex.fullmatch(a)]
+        state = self.state
+        chosen = []
+        for i, policy in wanted:
+            address = addresses[i]
+            value = values[i]
+            st = state.get(address)
+            if st is None:
+                state[address] = [value, now, 0.0]
+                chosen.append(i)
+                continue
+            delta = value - st[0]
+            elapsed = now - st[1]
+            if not (policy.keepalive and elapsed >= policy.keepalive):
+                need = policy.deadband
+                if delta * st[2] < 0:
+                    need += policy.hysteresis
+                if abs(delta) <= need or elapsed < policy.min_interval:
+                    continue
+            if delta:
+                st[2] = delta
+            st[0] = value
+            st[1] = now
+            chosen.append(i)
+        return chosen
+
+
+class OscSender:
+    """
+    Sends WC input values to every subscribed OSC client, one bundle per
+    device report.
+
+    Each report is encoded once however many clients there are: messages
+    are encoded on first use and whole datagrams are shared between
+    clients that get the same selection. The addresses are fixed, so a
+    message is a cached address/type-tag prefix plus one big-endian float —
+    much cheaper at 1kHz than building it with python-osc's builders.
+
+    Clients subscribe at runtime by sending /bridge/subscribe to the
+    bridge (see subscribe_handler); the subscriber list is replaced, never
+    mutated, so reader threads can iterate it without a lock. Changes to
+    it take self.lock.
+
+    A UDP source address is easily forged, so runtime subscriptions are
+    limited: only from allowed addresses (private ones by default), at
+    most MAX_SUBSCRIBERS at once, and each lapses after SUBSCRIPTION_TTL
+    seconds unless the client subscribes again.
+    """
+    MAX_SUBSCRIBERS = 16
+    SUBSCRIPTION_TTL = 60.0
+
+    def __init__(self, bundles="device", verbose=False, policies=None, allow=None):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.bundles = bundles
+        self.verbose = verbose
+        self.policies = policies or PolicyTable(DEFAULT_POLICIES)  # for new subscribers
+        self.allow = allow  # ipaddress networks allowed to subscribe; None: private addresses
+        self.prefixes = {}
+        self.subscribers = ()
+        self.lock = threading.Lock()
+        self.next_expiry = float("inf")
+
+    def add(self, subscriber):
+        """Add a client, replacing any earlier subscription to the same target."""
+        with self.lock:
+            others = tuple(s for s in self.subscribers if s.target != subscriber.target)
+            self.subscribers = others + (subscriber,)
+            if subscriber.expires is not None:
+                self.next_expiry = min(self.next_expiry, subscriber.expires)
+
+    def remove(self, target):
+        with self.lock:
+            self.subscribers = tuple(s for s in self.subscribers if s.target != target)
+
+    def expire(self, now):
+        """Drop subscriptions that weren't renewed in time."""
+        with self.lock:
+            lapsed = [s for s in self.subscribers if s.expires is not None and s.expires <= now]
+            self.subscribers = tuple(s for s in self.subscribers if s not in lapsed)
+            self.next_expiry = min((s.expires for s in self.subscribers if s.expires is not None),
+                                   default=float("inf"))
+        for s in lapsed:
+            print(f"Subscription lapsed: {s.target[0]}:{s.target[1]}")
+
+    def allowed(self, ip):
+        try:
+            addr = ipaddress.ip_address(ip)
+        except ValueError:
+            return False
+        if self.allow is None:
+            return addr.is_private or addr.is_loopback or addr.is_link_local
+        return any(addr in net for net in self.allow)
+
+    def subscribe_handler(self, client_address, address, *args):
+        """
+        /bridge/subscribe [port] [pattern] [rate] [threshold]
+        /bridge/unsubscribe [port]
+
+        The client is the sender's IP at port (default: the port it sent
+        from). pattern is an OSC address pattern such as /knob/* (default:
+        everything). rate (messages per second per address) and threshold
+        (deadband in volts) override the output policy for every address;
+        leave them out, or pass a negative rate, to keep the policy. A
+        negative threshold sends every value of every report, as -t -1.
+
+        Subscribing again with the same settings just renews the
+        subscription; with new ones it replaces it.
+        """
+        if not self.allowed(client_address[0]):
+            print(f"Refused subscription from {client_address[0]} (see --subscribe-allow)")
+            return
+        try:
+            port = int(args[0]) if args else client_address[1]
+            if not 1 <= port <= 65535:
+                raise ValueError(f"port {port} out of range")
+        except (TypeError, ValueError) as e:
+            print(f"Bad subscription from {client_address[0]}: {args} ({e})")
+            return
+        target = (client_address[0], port)
+        if address.endswith("/unsubscribe"):
+            self.remove(target)
+            print(f"Unsubscribed: {target[0]}:{target[1]}")
+            return
+        try:
+            pattern = str(args[1]) if len(args) > 1 else ""
+            rate = float(args[2]) if len(args) > 2 and float(args[2]) >= 0 else None
+            threshold = float(args[3]) if len(args) > 3 else None
+            overrides = threshold_overrides(threshold)
+            if rate is not None:
+                overrides["max_rate"] = rate
+            sub = Subscriber(target, pattern, self.policies.with_overrides(**overrides),
+                             expires=time.time() + self.SUBSCRIPTION_TTL)
+        except (TypeError, ValueError, re.error) as e:
+            print(f"Bad subscription from {client_address[0]}: {args} ({e})")
+            return
+        current = next((s for s in self.subscribers if s.target == target), None)
+        if current is not None and current.expires is None:
+            sub.expires = None  # the --osc-send-port target never lapses
+        if (current is not None and current.expires is not None and current.pattern == pattern
+                and current.policies.overrides == sub.policies.overrides):
+            current.expires = sub.expires  # renewal: keep its send state
+            return
+        if current is None and sum(s.expires is not None for s in self.subscribers) >= self.MAX_SUBSCRIBERS:
+            print(f"Refused subscription from {client_address[0]}:"
+                  f" already {self.MAX_SUBSCRIBERS} subscribers")
+            return
+        self.add(sub)
+        print(f"Subscribed: {sub.describe()}")
+
+    def map_handlers(self, disp):
+        disp.map("/bridge/subscribe", self.subscribe_handler, needs_reply_address=True)
+        disp.map("/bridge/unsubscribe", self.subscribe_handler, needs_reply_address=True)
+
+    def encode(self, address, value):
+        prefix = self.prefixes.get(address)
+        if prefix is None:
+            prefix = self.prefixes[address] = osc_string(address) + osc_string(",f")
+        return prefix + struct.pack('>f', value)
+
+    def send(self, addresses, values, timestamp=None, now=0.0):
+        """
+        Send one report: values[i] is the value for addresses[i]. timestamp
+        is the report's host time.time(), None to send it for immediately;
+        now is when it arrived, for rate limits.
+        """
+        if now >= self.next_expiry:
+            self.expire(now)
+        subscribers = self.subscribers
+        if not subscribers:
+            return
+        encoded = [None] * len(values)
+        datagrams = {}
+        for sub in subscribers:
+            chosen = sub.select(addresses, values, now)
+            if not chosen:
+                continue
+            for i in chosen:
+                if encoded[i] is None:
+                    encoded[i] = self.encode(addresses[i], values[i])
+                    if self.verbose:
+                        print(f"  [OSC out] {addresses[i]} {values[i]:.4f}")
+            # One unreachable client mustn't stop the others getting the report
+            try:
+                if self.bundles == "off":
+                    for i in chosen:
+                        self.sock.sendto(encoded[i], sub.target)
+                    continue
+                key = tuple(chosen)
+                dgram = datagrams.get(key)
+                if dgram is None:
+                    dgram = datagrams[key] = self.bundle(encoded, chosen, timestamp)
+                self.sock.sendto(dgram, sub.target)
+            except (OSError, OverflowError) as e:
+                if not sub.send_failed:
+                    print(f"Could not send to {sub.target[0]}:{sub.target[1]} ({e})")
+                sub.send_failed = True
+
+    def bundle(self, encoded, chosen, timestamp):
+        use_time = self.bundles == "device" and timestamp is not None
+        parts = [b"#bundle\0", ntp_timetag(timestamp) if use_time else TIMETAG_IMMEDIATELY]
+        for i in chosen:
+            msg = encoded[i]
+            parts.append(struct.pack('>i', len(msg)))
+            parts.append(msg)
+        return b"".join(parts)
+
+
 # ---------------------------------------------------------------------------
 # Serial helpers
 # ---------------------------------------------------------------------------
@@ -112,17 +781,22 @@ def get_local_ip():
         s.close()
 
 
-def find_wc_port():
-    """Try to auto-detect a Workshop Computer serial port."""
-    import serial.tools.list_ports
+def find_wc_ports():
+    """Serial ports that look like a Workshop Computer (Pico USB CDC)."""
     candidates = []
-    for port in serial.tools.list_ports.comports():
+    for port in list_ports.comports():
         dev = port.device.lower()
         if "usbmodem" in dev or "acm" in dev:
-            candidates.append(port)
+            candidates.append(port.device)
             print(f"  candidate: {port.device}  ({port.description})")
+    return candidates
+
+
+def find_wc_port():
+    """Try to auto-detect a Workshop Computer serial port."""
+    candidates = find_wc_ports()
     if len(candidates) == 1:
-        return candidates[0].device
+        return candidates[0]
     return None
 
 
@@ -133,142 +807,1029 @@ def open_serial(port):
     return ser
 
 
+def find_sync(buf, start=0, end=None):
+    """Index of the first device→host sync byte (input or event) in buf[start:end], or -1."""
+    if end is None:
+        end = len(buf)
+    i = buf.find(SYNC_DEVICE_TO_HOST, start, end)
+    j = buf.find(SYNC_DEVICE_EVENT, start, end)
+    if i < 0 or (0 <= j < i):
+        return j
+    return i
+
+
+class PacketDecoder:
+    """
+    Splits the device stream into 16-byte packets without per-packet copies.
+
+    Serial data is read straight into a preallocated buffer. decode() walks
+    the complete packets with one struct.iter_unpack pass over a memoryview
+    and just advances the read offset; after a lost sync it scans forward
+    with bytearray.find. The partial packet left at the end (< 16 bytes) is
+    moved to the front only when the buffer fills up.
+    """
+    REPORT = struct.Struct('<BB7h')  # sync, flags, cv1, cv2, audio1, audio2, knobs
+
+    def __init__(self, size=1 << 16):
+        self.buf = bytearray(size)
+        self.view = memoryview(self.buf)
+        self.start = 0
+        self.end = 0
+        self.record = None  # callback(raw packets, arrival), see Recorder
+
+    def make_room(self, want):
+        if self.end + want > len(self.buf):
+            n = self.end - self.start
+            self.buf[:n] = self.buf[self.start:self.end]
+            self.start, self.end = 0, n
+
+    def read(self, ser):
+        """Read whatever the port has (waiting up to its timeout for one byte). Returns count."""
+        want = max(1, min(ser.in_waiting, len(self.buf) // 2))
+        self.make_room(want)
+        got = ser.readinto(self.view[self.end:self.end + want])
+        self.end += got or 0
+        return got or 0
+
+    def read_fd(self, fd):
+        """Non-blocking read from the port's file descriptor straight into the buffer."""
+        self.make_room(len(self.buf) // 2)
+        try:
+            got = os.readv(fd, [self.view[self.end:]])
+        except BlockingIOError:
+            return 0
+        if got == 0:
+            raise serial.SerialException("device disconnected")
+        self.end += got
+        return got
+
+    def decode(self, packets, arrival=0.0):
+        """
+        Append every complete packet to packets, in stream order: reports as
+        REPORT tuples, events as (SYNC_DEVICE_EVENT, event id, payload bytes).
+        With a record callback set, each run of good packets is also passed
+        to it raw, with arrival (the host time they were read).
+        """
+        record = self.record
+        buf, view, size = self.buf, self.view, INPUT_PACKET_SIZE
+        pos, end = self.start, self.end
+        while end - pos >= size:
+            first = buf[pos]
+            if first != SYNC_DEVICE_TO_HOST and first != SYNC_DEVICE_EVENT:
+                idx = find_sync(buf, pos, end)
+                if idx < 0:
+                    pos = end
+                    break
+                pos = idx
+                continue
+            count = (end - pos) // size
+            done = count
+            for i, rec in enumerate(self.REPORT.iter_unpack(view[pos:pos + count * size])):
+                if rec[0] == SYNC_DEVICE_TO_HOST:
+                    packets.append(rec)
+                elif rec[0] == SYNC_DEVICE_EVENT:
+                    at = pos + i * size
+                    packets.append((SYNC_DEVICE_EVENT, rec[1], bytes(view[at + 2:at + size])))
+                else:
+                    done = i  # lost sync; rescan from here
+                    break
+            if record is not None and done:
+                record(view[pos:pos + done * size], arrival)
+            pos += done * size
+        self.start = pos
+
+
+def read_events(ser, event_id, count, timeout):
+    """Read the device stream until count events of event_id arrive (or timeout)."""
+    decoder = PacketDecoder()
+    packets = []
+    events = []
+    deadline = time.monotonic() + timeout
+    while len(events) < count and time.monotonic() < deadline:
+        decoder.read(ser)
+        decoder.decode(packets)
+        events.extend(p[2] for p in packets if p[0] == SYNC_DEVICE_EVENT and p[1] == event_id)
+        packets.clear()
+    return events
+
+
+def query_card_info(ser, timeout=1.0):
+    """(UniqueCardID, protocol version), or None if the card doesn't answer."""
+    ser.write(command_packet(CMD_GET_CARD_INFO))
+    events = read_events(ser, EVT_CARD_INFO, 1, timeout)
+    return struct.unpack_from('<QB', events[0]) if events else None
+
+
+def query_card_id(ser, timeout=1.0):
+    """The card's UniqueCardID, or None if it doesn't answer (not running the bridge)."""
+    info = query_card_info(ser, timeout)
+    return info[0] if info else None
+
+
+def calibrate_inputs(ser, which, reset=False):
+    """Measure (or reset) per-input offset/gain; the card stores it in flash."""
+    mask = CAL_INPUT_MASKS[which]
+    if reset:
+        ser.write(command_packet(CMD_RESET_INPUT_CAL, bytes((mask,))))
+    else:
+        print("Patch CV Out 1 → Audio In 1 / CV In 1 and CV Out 2 → Audio In 2 / CV In 2")
+        print("(only the inputs being calibrated). Measuring at -2V and +2V...")
+        ser.write(command_packet(CMD_CALIBRATE_INPUTS, bytes((mask,))))
+
+    count = bin(mask).count("1")
+    events = read_events(ser, EVT_INPUT_CAL, count, timeout=5.0)
+    for payload in events:
+        inp, status, offset_q4, gain_q16 = struct.unpack_from('<BBii', payload)
+        print(f"  {CAL_INPUT_NAMES[inp]:<10}  {CAL_STATUS.get(status, status):<40}"
+              f"  offset {offset_q4 / 16:+.2f}  gain {gain_q16 / 65536:.4f} mV/step")
+    if len(events) < count:
+        print("Calibration timed out — is the card running the bridge firmware?")
+        return False
+    return True
+
+
+def set_boot_mode(ser, mode):
+    """Store the boot mode on the card; the card ID query after it confirms the write."""
+    ser.write(command_packet(CMD_SET_BOOT_MODE, bytes((BOOT_MODES[mode],))))
+    card_id = query_card_id(ser)
+    if card_id is None:
+        print("  no answer — is the card running the bridge firmware?")
+        return False
+    print(f"  card {card_id:016x}: {mode} boot from the next power-up")
+    return True
+
+
+def show_boot_times(ser):
+    """Print how long each phase of the card's last startup took."""
+    ser.write(command_packet(CMD_GET_BOOT_TIMES))
+    events = read_events(ser, EVT_BOOT_TIMES, 1, timeout=1.0)
+    if not events:
+        print("  no answer — is the card running the bridge firmware?")
+        return False
+    source, *phases_us, first_ms = struct.unpack_from('<B5HH', events[0])
+    for name, us in zip(BOOT_PHASES, phases_us):
+        print(f"  {name:<22} {us / 1000:8.3f} ms{'+' if us == 0xFFFF else ''}")
+    rest_ms = first_ms - sum(phases_us) / 1000
+    print(f"  {'→ first report':<22} {rest_ms:8.3f} ms  (first report {first_ms} ms after reset)")
+    print(f"  CV Out calibration from {CAL_SOURCES.get(source, source)}")
+    return True
+
+
 # ---------------------------------------------------------------------------
 # OSC → Workshop Computer (binary USB)
 # ---------------------------------------------------------------------------
 
 class OutputBridge:
+    """
+    OSC handlers only record the latest values; a writer thread merges
+    everything that arrived since the last flush into at most one 0xC0
+    packet (plus one CMD_SET_CV_PRECISE in precise mode) per write_interval.
+    The default interval is one USB full-speed frame (1ms), so a burst of
+    fader moves costs one USB transaction instead of one per message.
+
+    With an asyncio loop the writer thread is replaced by flushes scheduled
+    on the loop with the same pacing.
+
+    Messages in bundles timetagged in the future are scheduled instead:
+    the timetag is converted to the card's sample clock and sent as
+    CMD_SCHEDULE up to SCHEDULE_LEAD ahead, so the card applies it on the
+    exact sample however late the UDP packet was (as long as it wasn't
+    later than the lead the sender allowed).
+
+    /pulse/N/trigger [ms] sends CMD_TRIGGER (or, timetagged, CMD_SCHEDULE
+    on a trigger channel): the card raises the pulse out and drops it again
+    after that many ms itself, so the width doesn't depend on when a later
+    packet gets through.
+
+    /pulse/N/clock source [multiply divide swing probability width] sends
+    CMD_SET_CLOCK: the card drives Pulse Out N from Pulse In <source>
+    itself, multiplied and divided, with swing (50-99%, 50 straight),
+    each pulse fired with the given probability (0-100%) for width ms.
+    Source 0 hands the output back to /pulse/N.
+    """
     NUM_CV = 4
-
-    def __init__(self, ser, verbose=False):
+    SCHEDULE_LEAD = 0.2      # seconds ahead to hand events to the card
+    SCHEDULE_IN_FLIGHT = 24  # card holds 28 (4 more for triggers); leave room for clock error
+    TRIGGER_DEFAULT_MS = 10.0
+    TRIGGER_MAX_US = 1000000  # fits CMD_SCHEDULE's signed 21-bit value
+    CLOCK_DEFAULTS = (0, 1, 1, 50, 100, 10.0)  # source, ×, ÷, swing %, probability %, width ms
+
+    def __init__(self, ser, verbose=False, cv_mode="native", write_interval=0.001, clock=None,
+                 loop=None, prefix=""):
         self.ser = ser
+        self.prefix = prefix  # e.g. "/wc/<id>" in multi-card mode
         self.verbose = verbose
+        self.cv_mode = cv_mode
+        self.write_interval = write_interval
+        self.clock = clock
 
         # Latest native values from OSC (1-indexed, [0] unused)
+        # In mv mode /ch/3-4 hold millivolts instead
         self.latest = [0] * (self.NUM_CV + 1)
+        # Latest calibrated 19-bit values for /ch/3-4 in precise mode
+        self.precise = [0, 0]
         self.pulse = [False, False]
+        self.triggers = []  # (pulse out, width µs) to send with the next flush
+        self.clocks = {}    # pulse out → CMD_SET_CLOCK payload to send with the next flush
         self.lock = threading.Lock()
 
-    def osc_handler(self, address, *args):
-        """Called by OSC dispatcher for /ch/* and /pulse/*. Sends immediately."""
+        # Set by osc_handler, cleared when the writer snapshots the state
+        self.data_dirty = False
+        self.precise_dirty = False
+        self.wake = threading.Event()
+        self.running = True
+        self.last_flush = 0.0  # perf_counter
+
+        # Event-loop mode: pending flush and when it will run (perf_counter)
+        self.loop = loop
+        self.flush_handle = None
+        self.flush_at = None
+
+        # Scheduled events: heap of (host time, seq, sample, channel, value, kind, num, volts)
+        # waiting to be sent, and those sent but not yet due
+        self.scheduled = []
+        self.in_flight = []
+        self.sched_seq = 0
+
+        mode = CV_MODES[cv_mode]
+        self.ser.write(command_packet(CMD_SET_CV_MODE, bytes((mode, mode))) + release_packets())
+
+        self.writer = None
+        if loop is None:
+            self.writer = threading.Thread(target=self.writer_thread, daemon=True)
+            self.writer.start()
+
+    @staticmethod
+    def parse(address, args):
+        """(kind, num, volts) for /ch/N and /pulse/N messages, else None."""
         if not args:
-            return
+            return None
         try:
             volts = float(args[0])
         except (ValueError, TypeError):
-            return
+            return None
 
         parts = address.strip("/").split("/")
         try:
             num = int(parts[-1])
         except (ValueError, IndexError):
-            return
+            return None
+        return parts[0], num, max(-6.0, min(6.0, volts))
 
-        volts = max(-6.0, min(6.0, volts))
-        native = volts_to_native(volts)
+    @classmethod
+    def parse_trigger(cls, address, args):
+        """(num, width µs) for /pulse/N/trigger [ms], else None."""
+        parts = address.strip("/").split("/")
+        if len(parts) != 3 or parts[0] != "pulse" or parts[2] != "trigger":
+            return None
+        try:
+            num = int(parts[1])
+            ms = float(args[0]) if args else cls.TRIGGER_DEFAULT_MS
+        except (ValueError, TypeError):
+            return None
+        if num not in (1, 2) or not ms > 0:
+            return None
+        return num, max(1, min(cls.TRIGGER_MAX_US, round(ms * 1000)))
+
+    def set_output(self, kind, num, volts):
+        """Record a value (caller holds self.lock). Returns "data", "precise" or None."""
+        is_cv_out = kind == "ch" and num in (3, 4)
+        if is_cv_out and self.cv_mode == "precise":
+            self.precise[num - 3] = volts_to_precise(volts)
+            return "precise"
+        if is_cv_out and self.cv_mode == "mv":
+            self.latest[num] = round(volts * 1000)
+        elif kind == "ch" and 1 <= num <= self.NUM_CV:
+            self.latest[num] = volts_to_native(volts)
+        elif kind == "pulse" and 1 <= num <= 2:
+            self.pulse[num - 1] = volts_to_native(volts) > 0
+        else:
+            return None
+        return "data"
 
+    def osc_handler(self, address, *args):
+        """Called by OSC dispatcher for /ch/* and /pulse/*. Never blocks on serial."""
+        parsed = self.parse(address[len(self.prefix):], args)
+        if parsed is None:
+            return
         with self.lock:
-            if parts[0] == "ch" and 1 <= num <= self.NUM_CV:
-                self.latest[num] = native
-            elif parts[0] == "pulse" and 1 <= num <= 2:
-                self.pulse[num - 1] = native > 0
+            changed = self.set_output(*parsed)
+            if changed == "precise":
+                self.precise_dirty = True
+            elif changed == "data":
+                self.data_dirty = True
             else:
                 return
-
-            flags = (0x01 if self.pulse[0] else 0) | (0x02 if self.pulse[1] else 0)
-            vals = self.latest[1:self.NUM_CV + 1]
-            packet = struct.pack('<BB4h',
-                                 SYNC_HOST_TO_DEVICE, flags,
-                                 vals[0], vals[1], vals[2], vals[3])
-            self.ser.write(packet)
+        self.notify()
 
         if self.verbose:
             print(f"  [OSC in] {address} {args[0]}")
 
+    def trigger_handler(self, address, *args):
+        """Called by OSC dispatcher for /pulse/*/trigger."""
+        parsed = self.parse_trigger(address[len(self.prefix):], args)
+        if parsed is None:
+            return
+        with self.lock:
+            self.triggers.append(parsed)
+        self.notify()
+
+        if self.verbose:
+            print(f"  [OSC in] {address} {parsed[1]}µs")
+
+    def clock_handler(self, address, *args):
+        """Called by OSC dispatcher for /pulse/*/clock."""
+        parts = address[len(self.prefix):].strip("/").split("/")
+        try:
+            num = int(parts[1])
+            source, mul, div, swing, chance, width = (
+                [float(a) for a in args[:6]] + list(self.CLOCK_DEFAULTS[len(args):]))
+        except (ValueError, TypeError, IndexError):
+            return
+        if num not in (1, 2) or source not in (0, 1, 2):
+            return
+        width = max(1, min(0x3FFF, round(width * 10)))  # 100µs units
+        payload = bytes((num - 1, int(source),
+                         max(1, min(127, round(mul))), max(1, min(127, round(div))),
+                         max(50, min(99, round(swing))), max(0, min(100, round(chance))),
+                         width & 0x7F, width >> 7))
+        with self.lock:
+            self.clocks[num] = payload
+        self.notify()
+
+        if self.verbose:
+            print(f"  [OSC in] {address} {' '.join(str(a) for a in args)}")
+
+    def schedule(self, when, address, *args):
+        """
+        Queue a message timetagged for host time `when` (time.time()) to be
+        applied by the card on the matching sample. Returns False if it
+        can't be scheduled (clock not synced yet), so the caller applies it now.
+        """
+        if self.clock is None:
+            return False
+        device = self.clock.host_to_device(when)
+        if device is None:
+            return False
+        addr = address[len(self.prefix):]
+        trigger = self.parse_trigger(addr, args)
+        if trigger is not None:
+            # Trigger channels follow the pulse outs; nothing to fold into
+            # the host-side state once the card has run it
+            num, value = trigger
+            channel, kind, volts = 5 + num, "trigger", 0.0
+        else:
+            parsed = self.parse(addr, args)
+            if parsed is None:
+                return True
+            kind, num, volts = parsed
+            if kind == "ch" and 1 <= num <= self.NUM_CV:
+                channel = num - 1
+                if num >= 3 and self.cv_mode != "native":
+                    value = volts_to_precise(volts)
+                else:
+                    value = volts_to_native(volts)
+            elif kind == "pulse" and 1 <= num <= 2:
+                channel = 3 + num
+                value = 1 if volts_to_native(volts) > 0 else 0
+            else:
+                return True
+        sample = round(device * SAMPLE_RATE)
+        with self.lock:
+            heapq.heappush(self.scheduled,
+                           (when, self.sched_seq, sample, channel, value, kind, num, volts))
+            self.sched_seq += 1
+        self.notify()
+
+        if self.verbose:
+            print(f"  [OSC in] {address} {value if trigger else args[0]} @ sample {sample}")
+        return True
+
+    def take_packets(self):
+        """Snapshot pending state into the bytes to write (empty if nothing changed)."""
+        with self.lock:
+            out = b""
+            if self.data_dirty:
+                flags = (0x01 if self.pulse[0] else 0) | (0x02 if self.pulse[1] else 0)
+                out += data_packet(flags, self.latest[1:self.NUM_CV + 1])
+            if self.precise_dirty:
+                out += command_packet(CMD_SET_CV_PRECISE,
+                                      pack_s21(self.precise[0]) + pack_s21(self.precise[1]))
+            for num, us in self.triggers:
+                out += command_packet(CMD_TRIGGER, bytes((num - 1,)) + pack_u21(us))
+            for payload in self.clocks.values():
+                out += command_packet(CMD_SET_CLOCK, payload)
+            self.data_dirty = False
+            self.precise_dirty = False
+            self.triggers = []
+            self.clocks = {}
+        return out
+
+    def take_scheduled(self, now):
+        """
+        CMD_SCHEDULE packets for events now within SCHEDULE_LEAD. Events the
+        card has applied are folded into the host-side state, so later 0xC0
+        packets carry them rather than the value they replaced.
+        """
+        out = b""
+        with self.lock:
+            if self.in_flight:
+                still = []
+                for ev in self.in_flight:
+                    if ev[0] <= now:
+                        self.set_output(*ev[5:])
+                    else:
+                        still.append(ev)
+                self.in_flight = still
+            while (self.scheduled and self.scheduled[0][0] - now <= self.SCHEDULE_LEAD
+                   and len(self.in_flight) < self.SCHEDULE_IN_FLIGHT):
+                ev = heapq.heappop(self.scheduled)
+                _, _, sample, channel, value = ev[:5]
+                out += command_packet(CMD_SCHEDULE,
+                                      pack_u28(sample) + bytes((channel,)) + pack_s21(value))
+                self.in_flight.append(ev)
+        return out
+
+    def next_deadline(self, now):
+        """Seconds until the writer next has scheduling work, or None."""
+        with self.lock:
+            times = [ev[0] for ev in self.in_flight]
+            if self.scheduled and len(self.in_flight) < self.SCHEDULE_IN_FLIGHT:
+                times.append(self.scheduled[0][0] - self.SCHEDULE_LEAD)
+        return max(0.0, min(times) - now) if times else None
+
+    def write_pending(self):
+        """Write changed values and due scheduled events, if any."""
+        out = self.take_packets() + self.take_scheduled(time.time())
+        if out:
+            self.ser.write(out)
+            self.last_flush = time.perf_counter()
+
+    def notify(self):
+        """Something changed: wake the writer thread, or schedule a flush on the loop."""
+        if self.loop is None:
+            self.wake.set()
+        else:
+            self.schedule_flush(0.0)
+
+    def schedule_flush(self, delay):
+        # Not before the tick is up; updates arriving meanwhile merge
+        at = max(time.perf_counter() + delay, self.last_flush + self.write_interval)
+        if self.flush_handle is not None:
+            if self.flush_at <= at:
+                return
+            self.flush_handle.cancel()
+        self.flush_at = at
+        self.flush_handle = self.loop.call_later(at - time.perf_counter(), self.loop_flush)
+
+    def loop_flush(self):
+        self.flush_handle = None
+        try:
+            self.write_pending()
+        except serial.SerialException:
+            print("Serial connection lost!")
+            self.loop.stop()
+            return
+        deadline = self.next_deadline(time.time())
+        if deadline is not None:
+            self.schedule_flush(deadline)
+
+    def writer_thread(self):
+        while self.running:
+            self.wake.wait(self.next_deadline(time.time()))
+            self.wake.clear()
+            # Hold off until the tick is up; updates arriving meanwhile merge
+            wait = self.last_flush + self.write_interval - time.perf_counter()
+            if wait > 0:
+                time.sleep(wait)
+            try:
+                self.write_pending()
+            except serial.SerialException:
+                print("Serial connection lost!")
+                return
+
+    def stop(self):
+        """Flush anything pending and stop the writer (before closing the port)."""
+        self.running = False
+        if self.writer is not None:
+            self.wake.set()
+            self.writer.join(timeout=1.0)
+        if self.flush_handle is not None:
+            self.flush_handle.cancel()
+            self.flush_handle = None
+        out = self.take_packets()
+        if out:
+            self.ser.write(out)
+
+
+class SchedulingDispatcher(dispatcher.Dispatcher):
+    """
+    Dispatcher that hands future-timetagged /ch/* and /pulse/* messages to
+    OutputBridge.schedule (of the card whose prefix they carry) instead of
+    sleeping the server thread until their time. Everything else is
+    dispatched immediately.
+    """
+
+    def __init__(self, bridges):
+        super().__init__()
+        self.routes = [(b.prefix + "/ch/", b.prefix + "/pulse/", b) for b in bridges]
+        for b in bridges:
+            self.map(b.prefix + "/ch/*", b.osc_handler)
+            self.map(b.prefix + "/pulse/*", b.osc_handler)
+            self.map(b.prefix + "/pulse/*/trigger", b.trigger_handler)
+            self.map(b.prefix + "/pulse/*/clock", b.clock_handler)
+
+    def bridge_for(self, address):
+        for ch, pulse, bridge in self.routes:
+            if address.startswith((ch, pulse)):
+                return bridge
+        return None
+
+    def call_handlers_for_packet(self, data, client_address):
+        try:
+            packet = osc_packet.OscPacket(data)
+        except osc_packet.ParseError:
+            return
+        now = time.time()
+        for timed in packet.messages:
+            msg = timed.message
+            if timed.time > now:
+                bridge = self.bridge_for(msg.address)
+                if bridge and bridge.schedule(timed.time, msg.address, *msg.params):
+                    continue
+            for handler in self.handlers_for_address(msg.address):
+                handler.invoke(client_address, msg)
+
+    async def async_call_handlers_for_packet(self, data, client_address):
+        # Nothing here blocks, so the asyncio server needn't await anything
+        self.call_handlers_for_packet(data, client_address)
+
 
 # ---------------------------------------------------------------------------
 # Workshop Computer → OSC (binary USB → OSC)
 # ---------------------------------------------------------------------------
 
-def reader_thread(ser, osc_client, verbose=False, threshold=0.005):
+class InputReporter:
     """
-    Reads binary packets from Workshop Computer and sends as OSC.
-    Only sends a message when the value has changed by more than threshold.
+    Turns decoded device packets into OSC.
+    Every report is handed to the OscSender as a whole, with the report's
+    device time; the sender decides per client which values changed enough
+    to send. With input_units="mv" the CV/audio fields are calibrated
+    millivolts.
 
     Device→Host packet (16 bytes):
       0xC1, flags, int16 cv1, int16 cv2, int16 audio1, int16 audio2,
       int16 knob_main, int16 knob_x, int16 knob_y
 
-    flags: bit 0 = pulse1, bit 1 = pulse2, bits 2-3 = switch (0/1/2)
+    flags: bit 0 = pulse1, bit 1 = pulse2, bits 2-3 = switch (0/1/2),
+           bits 4-7 = report sequence number
+    """
+    KNOB_VOLTS = 6.0 / 4095.0
+    ADDRESSES = ("/ch/1", "/ch/2", "/ch/3", "/ch/4", "/knob/main", "/knob/x", "/knob/y",
+                 "/switch", "/pulse/1", "/pulse/2")
+    # EVT_JACKS mask bits, in ComputerCard::Input order
+    JACK_ADDRESSES = ("/jack/ch/1", "/jack/ch/2", "/jack/ch/3", "/jack/ch/4",
+                      "/jack/pulse/1", "/jack/pulse/2")
+
+    def __init__(self, osc_out, clock, verbose=False, input_units="native", prefix=""):
+        self.osc_out = osc_out
+        self.addresses = tuple(prefix + a for a in self.ADDRESSES)
+        self.jack_addresses = tuple(prefix + a for a in self.JACK_ADDRESSES)
+        self.tempo_addresses = tuple((f"{prefix}/pulse/{n}/period", f"{prefix}/pulse/{n}/bpm")
+                                     for n in (1, 2))
+        self.clock = clock
+        self.verbose = verbose
+        self.to_volts = native_to_volts if input_units == "native" else (lambda mv: mv * 0.001)
+        self.decoder = PacketDecoder()
+        self.packets = []
+        self.shm = None  # SharedInputs, with --shm
+
+    def process(self, arrival):
+        """Decode everything read so far (arrived at host time arrival) and send it."""
+        clock = self.clock
+        send = self.osc_out.send
+        addresses = self.addresses
+        shm = self.shm
+        to_volts = self.to_volts
+        knob_volts = self.KNOB_VOLTS
+        self.decoder.decode(self.packets, arrival)
+
+        for pkt in self.packets:
+            if pkt[0] == SYNC_DEVICE_EVENT:
+                if pkt[1] == EVT_CLOCK:
+                    clock.on_clock_event(*struct.unpack_from('<IB', pkt[2]))
+                elif pkt[1] == EVT_JACKS:
+                    self.on_jacks(pkt[2][0], arrival)
+                elif pkt[1] == EVT_TEMPO:
+                    self.on_tempo(*struct.unpack_from('<BII', pkt[2]), arrival)
+                elif pkt[1] == EVT_SCHEDULE_FULL:
+                    channel, dropped = struct.unpack_from('<BI', pkt[2])
+                    print(f"Card schedule full: dropped an event for channel {channel}"
+                          f" ({dropped} dropped so far)")
+                elif self.verbose:
+                    print(f"  [event] 0x{pkt[1]:02x} {pkt[2].hex()}")
+                continue
+
+            _, flags, cv1, cv2, audio1, audio2, main_val, x_val, y_val = pkt
+            device_time = clock.on_report(flags >> 4, arrival)
+            timestamp = None if device_time is None else clock.device_to_host(device_time)
+
+            # Same order as ADDRESSES: inputs as OSC voltages (audio, then CV),
+            # knobs as 0.0-6.0V, then switch and pulses
+            values = (
+                to_volts(audio1), to_volts(audio2), to_volts(cv1), to_volts(cv2),
+                main_val * knob_volts, x_val * knob_volts, y_val * knob_volts,
+                float((flags >> 2) & 0x03),
+                1.0 if flags & 0x01 else 0.0,
+                1.0 if flags & 0x02 else 0.0,
+            )
+            if shm is not None:
+                shm.publish(arrival if timestamp is None else timestamp, clock.sample or 0,
+                            flags, values)
+            send(addresses, values, timestamp, arrival)
+        self.packets.clear()
+
+
+    def on_jacks(self, connected, arrival):
+        """EVT_JACKS: send 1.0/0.0 per jack; subscribers only get the ones that changed."""
+        values = tuple(1.0 if connected & (1 << i) else 0.0
+                       for i in range(len(self.jack_addresses)))
+        if self.verbose:
+            patched = [a for a, v in zip(self.JACK_ADDRESSES, values) if v]
+            print("  [jacks] " + (" ".join(patched) or "(none patched)"))
+        self.osc_out.send(self.jack_addresses, values, None, arrival)
+
+    def on_tempo(self, pulse_in, period, edge, arrival):
+        """
+        EVT_TEMPO: the card's estimate of the clock on a pulse in, as
+        /pulse/N/period (seconds) and /pulse/N/bpm (one pulse per beat),
+        both 0 once the clock stops. Timetagged with the last edge.
+        """
+        if pulse_in > 1:
+            return
+        seconds = period / 256 / SAMPLE_RATE
+        bpm = 60.0 / seconds if period else 0.0
+        timestamp = None
+        if self.clock.sample is not None:
+            sample = self.clock.sample + (edge - self.clock.sample + 2**31) % 2**32 - 2**31
+            timestamp = self.clock.device_to_host(sample / SAMPLE_RATE)
+        if self.verbose:
+            print(f"  [tempo] pulse {pulse_in + 1}: {bpm:.3f} bpm ({seconds * 1000:.3f}ms)")
+        self.osc_out.send(self.tempo_addresses[pulse_in], (seconds, bpm), timestamp, arrival)
+
+
+def reader_thread(ser, reporter):
+    """Blocking read loop for the threads engine; ends when the port is closed."""
+    while ser.is_open:
+        try:
+            if reporter.decoder.read(ser):
+                reporter.process(time.time())
+        except serial.SerialException:
+            print("Serial connection lost!")
+            sys.exit(1)
+        except Exception as e:
+            time.sleep(0.1)
+            if not ser.is_open:
+                break
+            print(f"Reader error: {e}")
+
+
+# ---------------------------------------------------------------------------
+# Shared-memory output (--shm) for local readers
+# ---------------------------------------------------------------------------
+#
+# One POSIX shared-memory segment per card holding the latest input frame
+# and a ring of recent frames, readable without syscalls (shm/wc_shm.h):
+#
+#   0    header: u32 magic "WCSM", u16 version, u16 header size, u32 frame
+#        size, u32 ring frames, u32 seq, u32 writer pid, u64 frames
+#        written, f64 created, char[24] OSC prefix
+#   64   latest frame, guarded by seq (odd while being written)
+#   128  ring: frame n in slot n % ring frames
+#
+#   frame: u64 index, f64 host time, u32 sample clock, u32 report flags,
+#          f32 values[10] in InputReporter.ADDRESSES order (volts)
+#
+# seq and frames written are stored with native-format structs, which write
+# a whole aligned word at once; the little-endian formats write byte by byte.
+
+SHM_MAGIC = 0x4D534357  # "WCSM"
+SHM_HEADER = struct.Struct('<IHHIIIIQd24s')
+SHM_FRAME = struct.Struct('<QdII10f')
+SHM_SEQ_OFFSET = 16
+SHM_WRITTEN_OFFSET = 24
+SHM_LATEST_OFFSET = 64
+SHM_RING_OFFSET = 128
+
+
+class StoreFence:
     """
-    buf = bytearray()
-    last = {}  # address → last sent value
+    Keeps the seqlock's stores in order on weakly ordered CPUs. Python has no
+    fence, but releasing a lock and taking it again is a release store
+    followed by an acquire, which nothing can be reordered across.
+    """
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.lock.acquire()
+
+    def __call__(self):
+        self.lock.release()
+        self.lock.acquire()
+
 
-    def send_if_changed(address, value):
-        prev = last.get(address)
-        if prev is None or abs(value - prev) > threshold:
-            osc_client.send_message(address, value)
-            last[address] = value
-            if verbose:
-                print(f"  [OSC out] {address} {value:.4f}")
+class SharedInputs:
+    """Publishes one card's input frames to a shared-memory segment."""
 
-    while True:
+    SEQ = struct.Struct('@I')
+    WRITTEN = struct.Struct('@Q')
+
+    def __init__(self, name, prefix="", ring_frames=4096):
+        size = SHM_RING_OFFSET + ring_frames * SHM_FRAME.size
         try:
-            data = ser.read(ser.in_waiting or 1)
-            if not data:
+            self.shm = shared_memory.SharedMemory(name, create=True, size=size)
+        except FileExistsError:
+            # Left behind by a bridge that didn't exit cleanly
+            stale = shared_memory.SharedMemory(name)
+            stale.close()
+            stale.unlink()
+            self.shm = shared_memory.SharedMemory(name, create=True, size=size)
+        self.name = name
+        self.buf = self.shm.buf
+        self.ring_frames = ring_frames
+        self.seq = 0
+        self.written = 0
+        self.fence = StoreFence()
+        SHM_HEADER.pack_into(self.buf, 0, SHM_MAGIC, 1, SHM_LATEST_OFFSET, SHM_FRAME.size,
+                             ring_frames, 0, os.getpid(), 0, time.time(), prefix.encode()[:23])
+
+    def publish(self, host_time, sample, flags, values):
+        buf = self.buf
+        n = self.written
+        self.seq += 1
+        self.SEQ.pack_into(buf, SHM_SEQ_OFFSET, self.seq)
+        self.fence()
+        frame = SHM_FRAME.pack(n, host_time, sample & 0xFFFFFFFF, flags, *values)
+        buf[SHM_LATEST_OFFSET:SHM_LATEST_OFFSET + SHM_FRAME.size] = frame
+        slot = SHM_RING_OFFSET + (n % self.ring_frames) * SHM_FRAME.size
+        buf[slot:slot + SHM_FRAME.size] = frame
+        self.fence()
+        self.written = n + 1
+        self.WRITTEN.pack_into(buf, SHM_WRITTEN_OFFSET, self.written)
+        self.seq += 1
+        self.SEQ.pack_into(buf, SHM_SEQ_OFFSET, self.seq)
+
+    def close(self):
+        self.buf = None
+        self.shm.close()
+        self.shm.unlink()
+
+
+# ---------------------------------------------------------------------------
+# Capture and replay (--record / --replay)
+# ---------------------------------------------------------------------------
+#
+# Capture file: a header, then fixed 32-byte records, one per device packet,
+# in the order they were read — so a file is valid up to its last whole
+# record however the bridge stopped, and can be mmapped as an array:
+#
+#   header   8s magic "WCSTREAM", u32 header size, u32 record size,
+#            JSON metadata (cards, input units), space-padded
+#   record   f64 host receive time (time.time()), u16 card index,
+#            6 bytes padding, 16-byte device packet as sent
+
+CAPTURE_MAGIC = b"WCSTREAM"
+CAPTURE_HEADER = struct.Struct('<8sII')
+CAPTURE_RECORD = struct.Struct(f'<dH6x{INPUT_PACKET_SIZE}s')
+
+
+class Recorder:
+    """Appends raw device packets to a capture file, from any reader thread."""
+
+    def __init__(self, path, metadata):
+        meta = json.dumps(metadata).encode()
+        size = CAPTURE_HEADER.size + len(meta)
+        size += -size % CAPTURE_RECORD.size
+        self.file = open(path, "wb")
+        self.file.write(CAPTURE_HEADER.pack(CAPTURE_MAGIC, size, CAPTURE_RECORD.size))
+        self.file.write(meta.ljust(size - CAPTURE_HEADER.size))
+        self.lock = threading.Lock()
+        self.count = 0
+
+    def channel(self, card):
+        """PacketDecoder.record callback for one card."""
+        def record(packets, arrival):
+            # Every packet of one read shares the record's time and card fields
+            head = CAPTURE_RECORD.pack(arrival, card, b"")[:-INPUT_PACKET_SIZE]
+            raw = bytes(packets)
+            data = b"".join(head + raw[i:i + INPUT_PACKET_SIZE]
+                            for i in range(0, len(raw), INPUT_PACKET_SIZE))
+            with self.lock:
+                self.file.write(data)
+                self.count += len(packets) // INPUT_PACKET_SIZE
+        return record
+
+    def close(self):
+        with self.lock:
+            self.file.close()
+
+
+def open_capture(path):
+    """(metadata, memoryview of the records) of a capture file, mmapped."""
+    with open(path, "rb") as f:
+        data = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    if len(data) < CAPTURE_HEADER.size:
+        raise ValueError("not a capture file")
+    magic, header_size, record_size = CAPTURE_HEADER.unpack_from(data)
+    if magic != CAPTURE_MAGIC or record_size != CAPTURE_RECORD.size:
+        raise ValueError("not a capture file, or from another version")
+    metadata = json.loads(bytes(data[CAPTURE_HEADER.size:header_size]))
+    count = (len(data) - header_size) // record_size
+    return metadata, memoryview(data)[header_size:header_size + count * record_size]
+
+
+class ReplayPort:
+    """
+    Stands in for a card's serial port during --replay: reads return what
+    the Replayer has fed in so far, writes (outputs) are counted and dropped.
+    """
+
+    def __init__(self, name):
+        self.name = name
+        self.pending = bytearray()
+        self.cond = threading.Condition()
+        self.is_open = True
+        self.written = 0
+
+    def feed(self, data):
+        with self.cond:
+            self.pending += data
+            self.cond.notify()
+
+    @property
+    def in_waiting(self):
+        return len(self.pending)
+
+    def readinto(self, buf):
+        with self.cond:
+            if not self.pending:
+                self.cond.wait(0.01)  # like the serial port's timeout
+            n = min(len(buf), len(self.pending))
+            buf[:n] = self.pending[:n]
+            del self.pending[:n]
+        return n
+
+    def write(self, data):
+        self.written += len(data)
+
+    def close(self):
+        self.is_open = False
+
+
+class Replayer:
+    """
+    Feeds a capture's packets to one ReplayPort per card at the recorded
+    pace, scaled by speed (0: as fast as the readers take them).
+    """
+
+    BACKLOG = 1 << 16  # bytes queued per port before waiting for its reader
+
+    def __init__(self, records, ports, speed=1.0):
+        self.records = records
+        self.ports = ports
+        self.speed = speed
+
+    def run(self, on_done):
+        start = time.monotonic()
+        first = None
+        last = None
+        batch = {}
+
+        def flush():
+            for card, data in batch.items():
+                port = self.ports[card]
+                while self.speed == 0 and len(port.pending) > self.BACKLOG and port.is_open:
+                    time.sleep(0.001)
+                port.feed(data)
+            batch.clear()
+
+        for arrival, card, packet in CAPTURE_RECORD.iter_unpack(self.records):
+            if card >= len(self.ports):
                 continue
-            buf.extend(data)
-
-            # Scan for complete packets
-            while len(buf) >= INPUT_PACKET_SIZE:
-                # Find sync byte
-                try:
-                    idx = buf.index(SYNC_DEVICE_TO_HOST)
-                except ValueError:
-                    buf.clear()
-                    break
+            # Packets read together were timestamped together: send them together
+            if arrival != last:
+                flush()
+                last = arrival
+                if first is None:
+                    first = arrival
+                if self.speed > 0:
+                    delay = start + (arrival - first) / self.speed - time.monotonic()
+                    if delay > 0:
+                        time.sleep(delay)
+            batch[card] = batch.get(card, b"") + packet
+        flush()
+        # Let the readers finish what's queued
+        while any(port.pending for port in self.ports):
+            time.sleep(0.01)
+        on_done()
 
-                # Discard bytes before sync
-                if idx > 0:
-                    del buf[:idx]
 
-                if len(buf) < INPUT_PACKET_SIZE:
-                    break
+# ---------------------------------------------------------------------------
+# Single event loop (asyncio engine)
+# ---------------------------------------------------------------------------
 
-                # Extract packet
-                pkt = bytes(buf[:INPUT_PACKET_SIZE])
-                del buf[:INPUT_PACKET_SIZE]
+class AsyncSerialWriter:
+    """
+    Non-blocking writes to the serial port's file descriptor. Whatever the
+    tty won't take now is queued and written when the loop says it's
+    writable, so the loop never blocks on USB.
+    """
 
-                flags = pkt[1]
-                cv1, cv2, audio1, audio2, knob_main, knob_x, knob_y = \
-                    struct.unpack_from('<7h', pkt, 2)
+    def __init__(self, ser, loop):
+        self.fd = ser.fileno()
+        self.loop = loop
+        self.queued = bytearray()
 
-                pulse1 = bool(flags & 0x01)
-                pulse2 = bool(flags & 0x02)
-                switch_pos = (flags >> 2) & 0x03
+    def write(self, data):
+        if self.queued:
+            self.queued += data
+            return
+        try:
+            n = os.write(self.fd, data)
+        except BlockingIOError:
+            n = 0
+        if n < len(data):
+            self.queued += data[n:]
+            self.loop.add_writer(self.fd, self.drain)
+
+    def drain(self):
+        try:
+            n = os.write(self.fd, self.queued)
+        except BlockingIOError:
+            return
+        del self.queued[:n]
+        if not self.queued:
+            self.loop.remove_writer(self.fd)
 
-                # Send inputs as OSC voltages (top-to-bottom: audio, CV)
-                send_if_changed("/ch/1", native_to_volts(audio1))
-                send_if_changed("/ch/2", native_to_volts(audio2))
-                send_if_changed("/ch/3", native_to_volts(cv1))
-                send_if_changed("/ch/4", native_to_volts(cv2))
 
-                # Send knobs as 0.0-6.0V
-                send_if_changed("/knob/main", knob_main * 6.0 / 4095.0)
-                send_if_changed("/knob/x", knob_x * 6.0 / 4095.0)
-                send_if_changed("/knob/y", knob_y * 6.0 / 4095.0)
+class Card:
+    """One connected Workshop Computer: its port, input side and output settings."""
 
-                # Send switch and pulses (always send — discrete values)
-                send_if_changed("/switch", float(switch_pos))
-                send_if_changed("/pulse/1", 1.0 if pulse1 else 0.0)
-                send_if_changed("/pulse/2", 1.0 if pulse2 else 0.0)
+    def __init__(self, port, ser, reporter, bridge_args, name=None):
+        self.port = port
+        self.ser = ser
+        self.reporter = reporter
+        self.bridge_args = bridge_args
+        self.name = name
+        self.bridge = None
 
-        except serial.SerialException:
-            print("Serial connection lost!")
-            sys.exit(1)
-        except Exception as e:
-            print(f"Reader error: {e}")
-            time.sleep(0.1)
+
+async def run_event_loop(cards, listen_addr, osc_out):
+    """
+    Run the whole bridge on one asyncio loop: the OSC server, serial reads
+    (add_reader on each port's fd) and paced serial writes. Returns on
+    Ctrl+C, or once every card's serial connection is lost.
+    """
+    loop = asyncio.get_running_loop()
+    for card in cards:
+        card.bridge = OutputBridge(AsyncSerialWriter(card.ser, loop), loop=loop, **card.bridge_args)
+    disp = SchedulingDispatcher([card.bridge for card in cards])
+    osc_out.map_handlers(disp)
+
+    server = osc_server.AsyncIOOSCUDPServer(listen_addr, disp, loop)
+    transport, _ = await server.create_serve_endpoint()
+
+    done = loop.create_future()
+    live = set()
+
+    def watch(card):
+        fd = card.ser.fileno()
+        reporter = card.reporter
+
+        def on_readable():
+            try:
+                if reporter.decoder.read_fd(fd):
+                    reporter.process(time.time())
+            except (serial.SerialException, OSError) as e:
+                print(f"Serial connection lost! {card.name or ''} ({e})")
+                loop.remove_reader(fd)
+                live.discard(card)
+                if not live and not done.done():
+                    done.set_result(None)
+
+        live.add(card)
+        loop.add_reader(fd, on_readable)
+
+    for card in cards:
+        watch(card)
+    try:
+        await done
+    finally:
+        for card in cards:
+            if card in live:
+                loop.remove_reader(card.ser.fileno())
+            card.bridge.stop()
+        transport.close()
 
 
 # ---------------------------------------------------------------------------
@@ -280,12 +1841,21 @@ def main():
         description="Bridge Workshop Computer (custom firmware) ↔ OSC"
     )
     parser.add_argument(
-        "--port", "-p",
-        help="Serial port for Workshop Computer (auto-detected if omitted)"
+        "--port", "-p", action="append",
+        help="Serial port for Workshop Computer (auto-detected if omitted); "
+             "repeat for several cards"
+    )
+    parser.add_argument(
+        "--all-cards", action="store_true",
+        help="Serve every connected card, with addresses under /wc/<card id>/"
+    )
+    parser.add_argument(
+        "--card-name", action="append", default=[], metavar="ID=NAME",
+        help="Use /wc/NAME/ instead of /wc/<card id>/ for the card with this (hex) id"
     )
     parser.add_argument(
         "--osc-send-port", type=int, default=7001,
-        help="UDP port to SEND OSC (WC inputs) (default: 7001)"
+        help="UDP port to SEND OSC (WC inputs) (default: 7001; 0 for subscribers only)"
     )
     parser.add_argument(
         "--osc-recv-port", type=int, default=7000,
@@ -300,52 +1870,261 @@ def main():
         help="Listen on 127.0.0.1 only (default: 0.0.0.0, all interfaces)"
     )
     parser.add_argument(
-        "--threshold", "-t", type=float, default=0.005,
-        help="Change threshold for OSC output — suppress messages below this (default: 0.005)"
+        "--threshold", "-t", type=float,
+        help="Change threshold (volts) for every OSC output address, overriding the "
+             "output policy's deadbands; negative sends every value of every report, "
+             "with no rate limit (default: per address, see --output-policy)"
+    )
+    parser.add_argument(
+        "--subscribe-allow", metavar="NET", action="append",
+        help="Accept /bridge/subscribe only from this address or network, e.g. "
+             "192.168.1.0/24; repeat for more (default: loopback and private addresses)"
+    )
+    parser.add_argument(
+        "--output-policy", metavar="FILE",
+        help="JSON file of per-address output policies: "
+             '{"/knob/*": {"deadband": 0.01, "hysteresis": 0.01, "max_rate": 100, "keepalive": 1}}'
+    )
+    parser.add_argument(
+        "--osc-bundles", choices=["device", "immediate", "off"], default="device",
+        help="One OSC bundle per card report, timetagged with the card's clock (device), "
+             "untimed (immediate), or separate messages (off) (default: device)"
+    )
+    parser.add_argument(
+        "--cv-mode", choices=list(CV_MODES), default="native",
+        help="CV Out (/ch/3-4) mode: native 11-bit, mv or precise calibrated (default: native)"
+    )
+    parser.add_argument(
+        "--input-units", choices=list(INPUT_UNITS), default="native",
+        help="Input (/ch/1-4) units from the card: native or calibrated mv (default: native)"
+    )
+    parser.add_argument(
+        "--knob-filter", choices=list(KNOB_FILTERS), default="smooth",
+        help="Knob smoothing on the card: smooth (fixed ~15Hz) or adaptive "
+             "(fast while turning, steady while still) (default: smooth)"
+    )
+    parser.add_argument(
+        "--cv-in-filter", choices=list(CV_IN_FILTERS), default="smooth",
+        help="CV In (/ch/3-4) filtering on the card: smooth (~240Hz) or raw "
+             "(unfiltered, averaged per report) (default: smooth)"
+    )
+    parser.add_argument(
+        "--norm-probe", choices=list(NORM_PROBES), default="always",
+        help="Jack detection on the card: always, scheduled (once a second) "
+             "or off (keep the last state) (default: always)"
+    )
+    parser.add_argument(
+        "--write-interval", type=float, default=1.0,
+        help="Minimum ms between serial writes; OSC updates in between are merged (default: 1, one USB frame)"
+    )
+    parser.add_argument(
+        "--engine", choices=["asyncio", "threads"],
+        default="asyncio" if os.name == "posix" else "threads",
+        help="Run everything on one asyncio event loop, or the threaded server "
+             "(default: asyncio; threads on Windows, where serial ports can't join the loop)"
+    )
+    parser.add_argument(
+        "--calibrate-inputs", choices=list(CAL_INPUT_MASKS),
+        help="Calibrate inputs against CV Out 1/2 (patched in), store on the card, then exit"
+    )
+    parser.add_argument(
+        "--reset-input-cal", choices=list(CAL_INPUT_MASKS),
+        help="Reset stored input calibration to nominal, then exit"
+    )
+    parser.add_argument(
+        "--boot-mode", choices=list(BOOT_MODES),
+        help="Store on the card whether it plays its startup pattern (animated, "
+             "alongside the bridge) or skips it (fast), then exit"
+    )
+    parser.add_argument(
+        "--boot-times", action="store_true",
+        help="Print how long each phase of the card's startup took, then exit"
     )
     parser.add_argument(
         "--show-traffic", "-s", nargs="?", const="all",
         choices=["all", "in", "out"],
         help="Show OSC traffic: all (default), in (from network), out (to network)"
     )
+    parser.add_argument(
+        "--shm", nargs="?", const="wc_bridge", metavar="NAME",
+        help="Also publish inputs to shared memory for local readers (shm/wc_shm.h); "
+             "NAME defaults to wc_bridge, with _<card> appended for several cards"
+    )
+    parser.add_argument(
+        "--record", metavar="FILE",
+        help="Record the raw device stream, with receive times, to FILE"
+    )
+    parser.add_argument(
+        "--replay", metavar="FILE",
+        help="Play a --record capture instead of talking to a card (threads engine)"
+    )
+    parser.add_argument(
+        "--replay-speed", type=float, default=1.0,
+        help="Replay speed: 1 real time, 10 ten times faster, 0 as fast as possible (default: 1)"
+    )
     args = parser.parse_args()
 
-    # --- Find serial port ---
-    port = args.port
-    if not port:
+    # --- Capture to replay, or find serial port(s) ---
+    replay_meta = None
+    if args.replay:
+        try:
+            replay_meta, replay_records = open_capture(args.replay)
+        except (OSError, ValueError) as e:
+            print(f"Could not open capture {args.replay}: {e}")
+            sys.exit(1)
+        if args.calibrate_inputs or args.reset_input_cal or args.boot_mode or args.boot_times:
+            print("Calibration, --boot-mode and --boot-times need a card, not a capture")
+            sys.exit(1)
+        args.input_units = replay_meta.get("input_units", "native")
+        if args.engine != "threads":
+            args.engine = "threads"
+            print("Replay runs on the threads engine")
+    ports = [c["port"] for c in replay_meta["cards"]] if replay_meta else args.port or []
+    multi = args.all_cards or len(ports) > 1
+    if not ports:
         print("Scanning for Workshop Computer...")
-        port = find_wc_port()
-        if not port:
+        ports = find_wc_ports() if args.all_cards else [p for p in [find_wc_port()] if p]
+        if not ports:
             print("Could not auto-detect Workshop Computer. Available ports:")
-            import serial.tools.list_ports
-            for p in serial.tools.list_ports.comports():
+            for p in list_ports.comports():
                 print(f"  {p.device}  -  {p.description}  ({p.manufacturer})")
-            print("\nSpecify with --port /dev/tty.usbmodemXXXX")
+            print("\nSpecify with --port /dev/tty.usbmodemXXXX, or use --all-cards")
             sys.exit(1)
 
-    print(f"Opening serial: {port}")
-    ser = open_serial(port)
+    if args.calibrate_inputs or args.reset_input_cal:
+        if len(ports) != 1:
+            print("Calibrate one card at a time: pick it with --port")
+            sys.exit(1)
+        print(f"Opening serial: {ports[0]}")
+        ser = open_serial(ports[0])
+        ok = calibrate_inputs(ser, args.calibrate_inputs or args.reset_input_cal,
+                              reset=bool(args.reset_input_cal))
+        ser.close()
+        sys.exit(0 if ok else 1)
+
+    if args.boot_mode:
+        ok = True
+        for port in ports:
+            print(f"Opening serial: {port}")
+            ser = open_serial(port)
+            ok = set_boot_mode(ser, args.boot_mode) and ok
+            ser.close()
+        sys.exit(0 if ok else 1)
+
+    if args.boot_times:
+        ok = True
+        for port in ports:
+            print(f"Opening serial: {port}")
+            ser = open_serial(port)
+            ok = show_boot_times(ser) and ok
+            ser.close()
+        sys.exit(0 if ok else 1)
+
+    names = {}
+    for entry in args.card_name:
+        card_id, _, name = entry.partition("=")
+        try:
+            if not name:
+                raise ValueError("no name")
+            if "/" in name:
+                raise ValueError("names can't contain /")
+            names[int(card_id, 16)] = name
+        except ValueError as e:
+            print(f"Bad --card-name {entry!r}: expected ID=NAME, ID in hex ({e})")
+            sys.exit(1)
 
-    # --- Set up the output bridge ---
+    # --- Set up OSC output and one Card per port ---
     show_in = args.show_traffic in ("all", "in")
     show_out = args.show_traffic in ("all", "out")
-    bridge = OutputBridge(ser, verbose=show_in)
-
-    # --- Set up OSC ---
     listen_ip = "127.0.0.1" if args.localhost else "0.0.0.0"
     local_ip = get_local_ip()
 
-    print(f"OSC send → {args.osc_send_ip}:{args.osc_send_port}  (WC inputs → OSC)")
-    client = udp_client.SimpleUDPClient(args.osc_send_ip, args.osc_send_port)
+    if args.osc_send_port:
+        print(f"OSC send → {args.osc_send_ip}:{args.osc_send_port}  (WC inputs → OSC)")
+    policy_entries = list(DEFAULT_POLICIES)
+    if args.output_policy:
+        try:
+            policy_entries += load_policies(args.output_policy)
+        except (OSError, ValueError, re.error) as e:
+            print(f"Could not load output policy {args.output_policy}: {e}")
+            sys.exit(1)
+    policies = PolicyTable(policy_entries, overrides=threshold_overrides(args.threshold))
+    if args.output_policy:
+        print(f"Output policy ({args.output_policy}):")
+        for address in InputReporter.ADDRESSES:
+            print(f"  {address:<11} {policies.policy(address).describe()}")
+    allow = None
+    if args.subscribe_allow:
+        try:
+            allow = [ipaddress.ip_network(n, strict=False) for n in args.subscribe_allow]
+        except ValueError as e:
+            print(f"Bad --subscribe-allow: {e}")
+            sys.exit(1)
+    osc_out = OscSender(bundles=args.osc_bundles, verbose=show_out, policies=policies, allow=allow)
+    if args.osc_send_port:
+        osc_out.add(Subscriber((args.osc_send_ip, args.osc_send_port), policies=policies))
+
+    cards = []
+    for port in ports:
+        if replay_meta:
+            card_meta = replay_meta["cards"][len(cards)]
+            ser = ReplayPort(port)
+            name = card_meta["name"]
+            prefix = card_meta["prefix"]
+            print(f"Replaying {port}" + (f" → {prefix}/..." if prefix else ""))
+        else:
+            print(f"Opening serial: {port}")
+            ser = open_serial(port)
+            prefix = ""
+            name = None
+        if not replay_meta:
+            info = query_card_info(ser)
+            if info is None:
+                print(f"  no answer from {port} — not running the bridge firmware? skipping")
+                ser.close()
+                continue
+            card_id, version = info
+            if version != PROTOCOL_VERSION:
+                print(f"  card {card_id:016x} speaks protocol {version}, this bridge"
+                      f" {PROTOCOL_VERSION} — write the matching wc_osc_bridge.uf2 to it; skipping")
+                ser.close()
+                continue
+        if multi and not replay_meta:
+            name = names.get(card_id, f"{card_id:016x}")
+            prefix = f"/wc/{name}"
+            print(f"  card {card_id:016x} → {prefix}/...")
+        ser.write(command_packet(CMD_SET_INPUT_UNITS, bytes((INPUT_UNITS[args.input_units],))))
+        ser.write(command_packet(CMD_SET_KNOB_FILTER, bytes((KNOB_FILTERS[args.knob_filter],))))
+        ser.write(command_packet(CMD_SET_CV_IN_FILTER, bytes((CV_IN_FILTERS[args.cv_in_filter],))))
+        ser.write(command_packet(CMD_SET_NORM_PROBE, bytes((NORM_PROBES[args.norm_probe],))))
+        clock = DeviceClock()
+        reporter = InputReporter(osc_out, clock, show_out, args.input_units, prefix=prefix)
+        bridge_args = dict(verbose=show_in, cv_mode=args.cv_mode,
+                           write_interval=args.write_interval / 1000, clock=clock, prefix=prefix)
+        cards.append(Card(port, ser, reporter, bridge_args, name))
+    if not cards:
+        sys.exit(1)
+
+    for card in cards:
+        if args.shm:
+            name = f"{args.shm}_{card.name}" if multi else args.shm
+            card.reporter.shm = SharedInputs(name, card.bridge_args["prefix"])
+            print(f"Shared memory: /{name}")
+
+    recorder = None
+    if args.record:
+        recorder = Recorder(args.record, {
+            "version": 1,
+            "started": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            "input_units": args.input_units,
+            "cards": [dict(port=card.port, name=card.name, prefix=card.bridge_args["prefix"])
+                      for card in cards],
+        })
+        for i, card in enumerate(cards):
+            card.reporter.decoder.record = recorder.channel(i)
+        print(f"Recording device stream to {args.record}")
 
     print(f"OSC recv ← {listen_ip}:{args.osc_recv_port}  (OSC → WC outputs)")
-    disp = dispatcher.Dispatcher()
-    disp.map("/ch/*", bridge.osc_handler)
-    disp.map("/pulse/*", bridge.osc_handler)
-
-    osc_srv = osc_server.ThreadingOSCUDPServer(
-        (listen_ip, args.osc_recv_port), disp
-    )
 
     # --- Advertise via Zeroconf (mDNS) for TouchOSC discovery ---
     zc = None
@@ -364,35 +2143,69 @@ def main():
         except Exception as e:
             print(f"Zeroconf: could not advertise ({e})")
 
-    # --- Start reader thread ---
-    threading.Thread(
-        target=reader_thread,
-        args=(ser, client, show_out, args.threshold),
-        daemon=True,
-    ).start()
-
-    print(f"\nBridge running (send-on-receive, out={OUTPUT_PACKET_SIZE}B in={INPUT_PACKET_SIZE}B). Ctrl+C to quit.\n")
+    ns = "/wc/<card>" if multi else ""
+    print(f"\nBridge running ({args.engine}, {len(cards)} card{'s' if len(cards) > 1 else ''},"
+          f" writes every {args.write_interval:g}ms max, out={OUTPUT_PACKET_SIZE}B"
+          f" in={INPUT_PACKET_SIZE}B). Ctrl+C to quit.\n")
     print(f"  Local IP: {local_ip}")
-    print(f"  Send to bridge:      port {args.osc_recv_port}  (/ch/1-4, /pulse/1-2)")
-    print(f"  Receive from bridge: port {args.osc_send_port}  (/ch/1-4, /knob/*, /switch, /pulse/1-2)")
+    print(f"  Send to bridge:      port {args.osc_recv_port}  ({ns}/ch/1-4, {ns}/pulse/1-2)")
+    print(f"  Receive from bridge: port {args.osc_send_port}  "
+          f"({ns}/ch/1-4, {ns}/knob/*, {ns}/switch, {ns}/pulse/1-2, {ns}/jack/*/*)")
+    print(f"  Subscribe:           /bridge/subscribe [port] [pattern] [rate] [threshold]"
+          f" to port {args.osc_recv_port}")
     print()
 
+    osc_srv = None
     try:
-        osc_srv.serve_forever()
+        if args.engine == "asyncio":
+            asyncio.run(run_event_loop(cards, (listen_ip, args.osc_recv_port), osc_out))
+        else:
+            for card in cards:
+                card.bridge = OutputBridge(card.ser, **card.bridge_args)
+                threading.Thread(target=reader_thread, args=(card.ser, card.reporter),
+                                 daemon=True).start()
+            disp = SchedulingDispatcher([card.bridge for card in cards])
+            osc_out.map_handlers(disp)
+            osc_srv = osc_server.ThreadingOSCUDPServer((listen_ip, args.osc_recv_port), disp)
+            if replay_meta:
+                def replay_done():
+                    print(f"\nReplay of {args.replay} finished")
+                    osc_srv.shutdown()
+                replayer = Replayer(replay_records, [card.ser for card in cards], args.replay_speed)
+                threading.Thread(target=replayer.run, args=(replay_done,), daemon=True).start()
+            try:
+                osc_srv.serve_forever()
+            finally:
+                for card in cards:
+                    try:
+                        card.bridge.stop()
+                    except serial.SerialException:
+                        pass
     except KeyboardInterrupt:
-        print("\nShutting down...")
-        # Zero all outputs on exit
-        packet = struct.pack('<BB4h', SYNC_HOST_TO_DEVICE, 0x00, 0, 0, 0, 0)
+        pass
+
+    print("\nShutting down...")
+    # Zero all outputs on exit, and stop anything the card would run on its own
+    packet = data_packet(0, (0, 0, 0, 0))
+    for card in cards:
         try:
-            ser.write(packet)
+            card.ser.write(packet)
+            card.ser.write(command_packet(CMD_SET_CV_PRECISE, pack_s21(0) + pack_s21(0)))
+            card.ser.write(release_packets())
         except serial.SerialException:
             pass
-        ser.close()
-        osc_srv.shutdown()
-        if zc:
-            zc.unregister_service(zc_info)
-            zc.close()
-        print("Done.")
+        card.ser.close()
+        if card.reporter.shm:
+            card.reporter.shm.close()
+    if recorder:
+        recorder.close()
+        print(f"Recorded {recorder.count} packets to {args.record}")
+    if osc_srv:
+        osc_srv.server_close()
+    if zc:
+        zc.unregister_service(zc_info)
+        zc.close()
+    print("Done.")
 
 
 if __name__ == "__main__":